@@ -0,0 +1,143 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+// Cross-checks the built-in encoder against libqrencode, module for module,
+// on a generated corpus (numeric, alphanumeric, mixed, binary and UTF-8
+// payloads of many lengths) plus any files given on the command line (one
+// payload per line), at all four error correction levels.
+//
+// Usage: fastqr_encoder_check [FILE...]
+
+#include "qr_encoder.h"
+#include <qrencode.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The calls fastqr made before it had its own encoder
+QRcode* reference_encode(const std::string& data, QRecLevel level) {
+    for (unsigned char c : data) {
+        if (c > 127) {
+            return QRcode_encodeData(static_cast<int>(data.size()),
+                                     reinterpret_cast<const unsigned char*>(data.data()), 0, level);
+        }
+    }
+    return QRcode_encodeString(data.c_str(), 0, level, QR_MODE_8, 1);
+}
+
+std::string random_string(std::mt19937& rng, const std::string& alphabet, size_t length) {
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::string out;
+    for (size_t i = 0; i < length; i++) out += alphabet[pick(rng)];
+    return out;
+}
+
+std::vector<std::string> build_corpus() {
+    const std::string digits = "0123456789";
+    const std::string alnum = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+    const std::string mixed = alnum + "abcdefghijklmnopqrstuvwxyz?&=_#@!";
+    const std::string utf8 = "\xC3\xA9\xE2\x82\xAC\xE6\x97\xA5";  // e-acute, euro, CJK
+
+    std::mt19937 rng(20251016);
+    std::vector<std::string> corpus = {
+        "https://fastqr.dev/a",
+        "HELLO WORLD",
+        "01234567",
+        "WIFI:S:MyNetwork;T:WPA;P:password123;;",
+        "mailto:user@example.com?subject=Order%2012345",
+        "Xin ch\xC3\xA0o Vi\xE1\xBB\x87t Nam",
+    };
+    std::vector<size_t> lengths;
+    for (size_t n = 1; n <= 64; n++) lengths.push_back(n);
+    for (size_t n = 80; n <= 3000; n = n * 5 / 4) lengths.push_back(n);
+
+    for (size_t n : lengths) {
+        corpus.push_back(random_string(rng, digits, n));
+        corpus.push_back(random_string(rng, alnum, n));
+        corpus.push_back(random_string(rng, mixed, n));
+        corpus.push_back(random_string(rng, mixed, n / 2) + random_string(rng, digits, n - n / 2));
+        corpus.push_back(random_string(rng, alnum, n / 3) + random_string(rng, mixed, n / 3) +
+                         random_string(rng, digits, n - 2 * (n / 3)));
+        std::string text;
+        while (text.size() < n) text += utf8.substr(0, 2) + random_string(rng, mixed, 3);
+        corpus.push_back(text);
+    }
+    return corpus;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> corpus = build_corpus();
+    for (int i = 1; i < argc; i++) {
+        std::ifstream in(argv[i]);
+        if (!in) {
+            std::cerr << "Error: Cannot open " << argv[i] << std::endl;
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) corpus.push_back(line);
+        }
+    }
+
+    const fastqr::ErrorCorrectionLevel levels[] = {
+        fastqr::ErrorCorrectionLevel::LOW, fastqr::ErrorCorrectionLevel::MEDIUM,
+        fastqr::ErrorCorrectionLevel::QUARTILE, fastqr::ErrorCorrectionLevel::HIGH};
+    const QRecLevel qr_levels[] = {QR_ECLEVEL_L, QR_ECLEVEL_M, QR_ECLEVEL_Q, QR_ECLEVEL_H};
+    const char level_names[] = "LMQH";
+
+    int checked = 0;
+    int mismatches = 0;
+    for (const std::string& data : corpus) {
+        for (int l = 0; l < 4; l++) {
+            QRcode* ref = reference_encode(data, qr_levels[l]);
+            fastqr::QROptions options;
+            options.ec_level = levels[l];
+            options.segmentation = fastqr::QROptions::SEGMENT_COMPAT;
+            fastqr::qr::Matrix m;
+            bool ok = fastqr::qr::encode(data, options, m);
+
+            bool same = (ref != nullptr) == ok;
+            if (same && ref) {
+                same = ref->version == m.version && ref->width == m.width;
+                for (int i = 0; same && i < m.width * m.width; i++) {
+                    same = (ref->data[i] & 1) == (m.modules[i] & 1);
+                }
+            }
+            if (!same) {
+                mismatches++;
+                std::fprintf(stderr, "MISMATCH level %c, %zu bytes: libqrencode v%d, built-in v%d (mask %d): %.60s\n",
+                             level_names[l], data.size(), ref ? ref->version : 0, ok ? m.version : 0,
+                             m.mask, data.c_str());
+            }
+            if (ref) QRcode_free(ref);
+            checked++;
+        }
+    }
+
+    std::printf("Checked %d symbols: %d mismatches\n", checked, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+// Microbenchmarks for every render branch of generate(), with each pipeline
+// stage (encode, rasterize, compress) timed in isolation.
+//
+// Usage: fastqr_bench [--benchmark_filter=SUBSTR] [--benchmark_min_time=SECONDS] [--benchmark_list]
+//
+// Names: BM_<stage>/<branch>/<int|frac>/<dataset>/<size>
+//        BM_encode/<dataset>/<level>[/mask_fast|/mask_0]
+//   int  = size is an exact multiple of the QR width (integer scale path)
+//   frac = non-integer scale path
+
+#include "fastqr.h"
+#include "fastqr_internal.h"
+#include "reed_solomon.h"
+#include "text_class.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using fastqr::detail::RasterImage;
+
+namespace {
+
+struct Benchmark {
+    std::string name;
+    std::function<size_t()> run;  // One iteration; returns output size (0 = failure)
+};
+
+// Render branches of fastqr::detail::rasterize()
+enum class Branch { INDEXED, INDEXED_MARGIN, BW_LOGO, GRAY, RGB };
+
+const char* branch_name(Branch branch, bool integer) {
+    switch (branch) {
+        // Non-integer black/white falls back to 8-bit grayscale
+        case Branch::INDEXED: return integer ? "indexed" : "indexed_gray_fallback";
+        case Branch::INDEXED_MARGIN: return integer ? "indexed_margin" : "indexed_margin_gray_fallback";
+        case Branch::BW_LOGO: return "bw_logo";
+        case Branch::GRAY: return "gray";
+        case Branch::RGB: return "rgb";
+    }
+    return "?";
+}
+
+const int MARGIN_PX = 8;
+
+fastqr::QROptions branch_options(Branch branch, const std::string& logo_path) {
+    fastqr::QROptions options;
+    options.margin_modules = 0;  // Keep the scale exactly as chosen below
+    switch (branch) {
+        case Branch::INDEXED:
+            break;
+        case Branch::INDEXED_MARGIN:
+            options.margin = MARGIN_PX;
+            break;
+        case Branch::BW_LOGO:
+            options.logo_path = logo_path;
+            break;
+        case Branch::GRAY:
+            options.foreground = {40, 40, 40};
+            options.background = {230, 230, 230};
+            break;
+        case Branch::RGB:
+            options.foreground = {200, 0, 60};
+            options.background = {255, 255, 220};
+            break;
+    }
+    return options;
+}
+
+// Pick an output size near `target` that lands on the integer or fractional path
+int pick_size(int qr_width, int target, int margin, bool integer) {
+    int scale = std::max(1, (target - 2 * margin) / qr_width);
+    int size = 2 * margin + scale * qr_width;
+    return integer ? size : size + qr_width / 2;
+}
+
+double run_benchmark(const Benchmark& bench, double min_time, long& iterations, size_t& bytes) {
+    using clock = std::chrono::steady_clock;
+    bytes = bench.run();  // Warm-up (file cache, allocator)
+
+    iterations = 1;
+    for (;;) {
+        auto start = clock::now();
+        for (long i = 0; i < iterations; i++) {
+            bytes = bench.run();
+        }
+        double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        if (elapsed >= min_time || iterations >= (1L << 30)) {
+            return elapsed * 1e9 / iterations;
+        }
+        // Aim a bit past min_time, growing at most 10x per round
+        double factor = elapsed > 0 ? min_time * 1.4 / elapsed : 10.0;
+        iterations = static_cast<long>(iterations * std::min(10.0, std::max(2.0, factor)));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    double min_time = 0.2;
+    bool list_only = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 19, "--benchmark_filter=") == 0) {
+            filter = arg.substr(19);
+        } else if (arg.compare(0, 21, "--benchmark_min_time=") == 0) {
+            min_time = std::atof(arg.c_str() + 21);
+        } else if (arg == "--benchmark_list") {
+            list_only = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--benchmark_filter=SUBSTR] [--benchmark_min_time=SECONDS] [--benchmark_list]\n";
+            return 1;
+        }
+    }
+
+    // Colored logo for the logo branch
+    const char* tmp = std::getenv("TMPDIR");
+    std::string logo_path = std::string(tmp ? tmp : "/tmp") + "/fastqr_bench_logo.png";
+    fastqr::QROptions logo_options;
+    logo_options.size = 120;
+    logo_options.foreground = {0, 90, 200};
+    logo_options.background = {250, 200, 0};
+    if (!fastqr::generate("logo", logo_path, logo_options)) {
+        std::cerr << "Error: Cannot create benchmark logo at " << logo_path << std::endl;
+        return 1;
+    }
+
+    // Small / medium / large payloads (byte mode); named after the QR
+    // version they encode to at EC level M
+    std::vector<std::string> payloads = {
+        "https://fastqr.dev/a",
+        std::string(120, 'x'),
+        std::string(300, 'x'),
+    };
+    const int target_sizes[] = {300, 1000, 2000};
+    const Branch branches[] = {Branch::INDEXED, Branch::INDEXED_MARGIN, Branch::BW_LOGO, Branch::GRAY, Branch::RGB};
+
+    std::vector<Benchmark> benchmarks;
+
+    for (const std::string& data : payloads) {
+        auto qr = std::make_shared<fastqr::detail::QRMatrix>();
+        if (!fastqr::detail::encode_qr(data, fastqr::QROptions(), *qr)) {
+            std::cerr << "Error: Cannot encode payload of " << data.size() << " bytes" << std::endl;
+            return 1;
+        }
+        int qr_width = qr->width;
+        std::string version = "v" + std::to_string(qr->version);
+
+        // Encode stage (independent of rendering), with each mask selection mode
+        const std::pair<int, const char*> mask_modes[] = {
+            {fastqr::QROptions::MASK_AUTO, ""},
+            {fastqr::QROptions::MASK_FAST, "/mask_fast"},
+            {0, "/mask_0"},
+        };
+        for (auto level : {fastqr::ErrorCorrectionLevel::MEDIUM, fastqr::ErrorCorrectionLevel::HIGH}) {
+            for (const auto& mode : mask_modes) {
+                std::string name = "BM_encode/" + version +
+                                   (level == fastqr::ErrorCorrectionLevel::HIGH ? "/H" : "/M") + mode.second;
+                fastqr::QROptions options;
+                options.ec_level = level;
+                options.mask = mode.first;
+                benchmarks.push_back({name, [&data, options]() -> size_t {
+                    fastqr::detail::QRMatrix qr;
+                    return fastqr::detail::encode_qr(data, options, qr) ? qr.modules.size() : 0;
+                }});
+            }
+        }
+
+        for (Branch branch : branches) {
+            for (bool integer : {true, false}) {
+                for (int target : target_sizes) {
+                    fastqr::QROptions options = branch_options(branch, logo_path);
+                    options.size = pick_size(qr_width, target, options.margin, integer);
+
+                    std::string suffix = std::string("/") + branch_name(branch, integer) +
+                                         (integer ? "/int/" : "/frac/") + version + "/" +
+                                         std::to_string(options.size);
+
+                    // Pre-rendered image for the compress-only benchmark
+                    auto image = std::make_shared<RasterImage>();
+                    if (!fastqr::detail::rasterize(*qr, options, *image)) {
+                        std::cerr << "Error: Cannot rasterize" << suffix << std::endl;
+                        return 1;
+                    }
+
+                    benchmarks.push_back({"BM_total" + suffix, [&data, options]() -> size_t {
+                        std::vector<uint8_t> png;
+                        return fastqr::generate_to_buffer(data, png, options) ? png.size() : 0;
+                    }});
+                    benchmarks.push_back({"BM_rasterize" + suffix, [qr, options]() -> size_t {
+                        RasterImage out;
+                        return fastqr::detail::rasterize(*qr, options, out) ? out.pixels.size() : 0;
+                    }});
+                    benchmarks.push_back({"BM_compress" + suffix, [image]() -> size_t {
+                        std::vector<uint8_t> png;
+                        fastqr::PngSink sink;
+                        sink.buffer = &png;
+                        return fastqr::detail::write_png(sink, *image) ? png.size() : 0;
+                    }});
+                    if (!integer) {
+                        fastqr::QROptions area = options;
+                        area.scaling = fastqr::QROptions::SCALE_AREA;
+                        benchmarks.push_back({"BM_rasterize_area" + suffix, [qr, area]() -> size_t {
+                            RasterImage out;
+                            return fastqr::detail::rasterize(*qr, area, out) ? out.pixels.size() : 0;
+                        }});
+                    }
+                }
+            }
+        }
+    }
+
+    // Mode classification of long payloads (text -> per-character mode bits)
+    std::string vcard;
+    while (vcard.size() < 2500) {
+        vcard += "BEGIN:VCARD\nVERSION:3.0\nN:Doe;John\nTEL:+1-555-0100\nEMAIL:john@example.com\nEND:VCARD\n";
+    }
+    std::string japanese;
+    while (japanese.size() < 2500) {
+        japanese += "\xE6\x9D\xB1\xE4\xBA\xAC\xE9\x83\xBD 1-2-3 \xE3\x83\x86\xE3\x82\xB9\xE3\x83\x88 ";
+    }
+    const std::pair<const char*, const std::string*> texts[] = {{"vcard", &vcard}, {"japanese", &japanese}};
+    for (const auto& text : texts) {
+        const std::string* data = text.second;
+        benchmarks.push_back({std::string("BM_classify/") + text.first, [data]() -> size_t {
+            std::vector<uint8_t> modes(data->size());
+            fastqr::qr::TextClass tc = fastqr::qr::classify_text(data->data(), data->size(), modes.data());
+            return tc.kanji ? modes.size() : 0;
+        }});
+    }
+
+    // Error correction of a version 40-H symbol: 20 blocks of 15 and 61
+    // blocks of 16 data codewords, 30 ECC codewords each
+    auto rs_data = std::make_shared<std::vector<uint8_t>>(20 * 15 + 61 * 16);
+    for (size_t i = 0; i < rs_data->size(); i++) {
+        (*rs_data)[i] = static_cast<uint8_t>(i * 131 + 7);
+    }
+    benchmarks.push_back({"BM_rs/v40/H", [rs_data]() -> size_t {
+        std::vector<uint8_t> ecc(30 * 81);
+        const fastqr::qr::RsGenerator& gen = fastqr::qr::rs_generator(30);
+        fastqr::qr::rs_encode_group(gen, rs_data->data(), 15, 20, ecc.data(), 81);
+        fastqr::qr::rs_encode_group(gen, rs_data->data() + 20 * 15, 16, 61, ecc.data() + 20, 81);
+        return ecc[0] != ecc[1] || ecc[2] != ecc[3] ? ecc.size() : 1;
+    }});
+
+    std::printf("%-62s %14s %12s %10s\n", "Benchmark", "Time (ns)", "Iterations", "Output");
+    std::printf("%s\n", std::string(101, '-').c_str());
+
+    int failures = 0;
+    for (const Benchmark& bench : benchmarks) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        if (list_only) {
+            std::printf("%s\n", bench.name.c_str());
+            continue;
+        }
+
+        long iterations;
+        size_t bytes;
+        double ns = run_benchmark(bench, min_time, iterations, bytes);
+        if (bytes == 0) failures++;
+        std::printf("%-62s %14.0f %12ld %10zu\n", bench.name.c_str(), ns, iterations, bytes);
+        std::fflush(stdout);
+    }
+
+    std::remove(logo_path.c_str());
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+{
+  "variables": {
+    # Library sources: bundled copy in published packages, repo root otherwise
+    "fastqr_root%": "<!(node -p \"require('fs').existsSync('deps/fastqr') ? 'deps/fastqr' : '../..'\")"
+  },
+  "targets": [
+    {
+      "target_name": "fastqr",
+      "sources": [
+        "fastqr_node.cpp",
+        "<(fastqr_root)/src/fastqr.cpp",
+        "<(fastqr_root)/src/batch.cpp",
+        "<(fastqr_root)/src/qr_encoder.cpp",
+        "<(fastqr_root)/src/reed_solomon.cpp",
+        "<(fastqr_root)/src/text_class.cpp",
+        "<(fastqr_root)/src/cache.cpp"
+      ],
+      "include_dirs": [
+        "<(fastqr_root)/include",
+        "<!@(pkg-config --cflags-only-I libpng | sed 's/-I//g')"
+      ],
+      "libraries": [
+        "<!@(pkg-config --libs libpng)"
+      ],
+      "cflags_cc": ["-std=c++14", "-O3"],
+      "cflags_cc!": ["-fno-exceptions"],
+      "xcode_settings": {
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++14",
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "GCC_OPTIMIZATION_LEVEL": "3"
+      }
+    }
+  ]
+}
@@ -0,0 +1,370 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#include "fastqr.h"
+#include <node_api.h>
+#include <string>
+#include <vector>
+
+#define NAPI_CALL(env, call)                                        \
+    do {                                                            \
+        if ((call) != napi_ok) {                                    \
+            napi_throw_error((env), nullptr, "N-API call failed");  \
+            return nullptr;                                         \
+        }                                                           \
+    } while (0)
+
+// Read a JS string argument
+static bool get_string(napi_env env, napi_value value, std::string& out) {
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) {
+        return false;
+    }
+    std::vector<char> buf(length + 1);
+    if (napi_get_value_string_utf8(env, value, buf.data(), buf.size(), &length) != napi_ok) {
+        return false;
+    }
+    out.assign(buf.data(), length);
+    return true;
+}
+
+// Look up an optional property; returns false if missing or undefined
+static bool get_property(napi_env env, napi_value obj, const char* name, napi_value& out) {
+    bool has = false;
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) {
+        return false;
+    }
+    if (napi_get_named_property(env, obj, name, &out) != napi_ok) {
+        return false;
+    }
+    napi_valuetype type;
+    napi_typeof(env, out, &type);
+    return type != napi_undefined && type != napi_null;
+}
+
+static void get_int(napi_env env, napi_value obj, const char* name, int& out) {
+    napi_value val;
+    if (get_property(env, obj, name, val)) {
+        napi_get_value_int32(env, val, &out);
+    }
+}
+
+static void get_color(napi_env env, napi_value obj, const char* name, fastqr::QROptions::Color& color) {
+    napi_value val;
+    bool is_array = false;
+    if (!get_property(env, obj, name, val) || napi_is_array(env, val, &is_array) != napi_ok || !is_array) {
+        return;
+    }
+    uint8_t* channels[3] = {&color.r, &color.g, &color.b};
+    for (uint32_t i = 0; i < 3; i++) {
+        napi_value item;
+        int32_t v = 0;
+        if (napi_get_element(env, val, i, &item) == napi_ok && napi_get_value_int32(env, item, &v) == napi_ok) {
+            *channels[i] = static_cast<uint8_t>(v);
+        }
+    }
+}
+
+// Convert JS options object to QROptions (same keys as the JS API)
+static fastqr::QROptions object_to_options(napi_env env, napi_value opts) {
+    fastqr::QROptions options;
+
+    napi_valuetype type = napi_undefined;
+    if (!opts || napi_typeof(env, opts, &type) != napi_ok || type != napi_object) {
+        return options;
+    }
+
+    napi_value val;
+    std::string str;
+
+    // Size (preferred) or width/height (backward compatibility), first
+    // one given wins - the same precedence as the CLI wrapper in index.js
+    if (get_property(env, opts, "size", val)) {
+        napi_get_value_int32(env, val, &options.size);
+    } else if (get_property(env, opts, "width", val)) {
+        napi_get_value_int32(env, val, &options.size);
+    } else {
+        get_int(env, opts, "height", options.size);
+    }
+
+    if (get_property(env, opts, "optimizeSize", val)) {
+        napi_get_value_bool(env, val, &options.optimize_size);
+    }
+
+    get_color(env, opts, "foreground", options.foreground);
+    get_color(env, opts, "background", options.background);
+
+    if (get_property(env, opts, "errorLevel", val) && get_string(env, val, str)) {
+        if (str == "L") options.ec_level = fastqr::ErrorCorrectionLevel::LOW;
+        else if (str == "M") options.ec_level = fastqr::ErrorCorrectionLevel::MEDIUM;
+        else if (str == "Q") options.ec_level = fastqr::ErrorCorrectionLevel::QUARTILE;
+        else if (str == "H") options.ec_level = fastqr::ErrorCorrectionLevel::HIGH;
+    }
+
+    if (get_property(env, opts, "logo", val) && get_string(env, val, str)) {
+        options.logo_path = str;
+    }
+    get_int(env, opts, "logoSize", options.logo_size_percent);
+    get_int(env, opts, "quality", options.quality);
+
+    if (get_property(env, opts, "format", val) && get_string(env, val, str)) {
+        options.format = str;
+    }
+
+    // Margin: absolute pixels take priority, like the CLI wrapper
+    if (get_property(env, opts, "margin", val)) {
+        napi_get_value_int32(env, val, &options.margin);
+        options.margin_modules = 0;
+    } else {
+        get_int(env, opts, "marginModules", options.margin_modules);
+    }
+
+    return options;
+}
+
+// generate(data, outputPath, options) -> boolean
+static napi_value Generate(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+
+    std::string data, output_path;
+    if (argc < 2 || !get_string(env, argv[0], data) || !get_string(env, argv[1], output_path)) {
+        napi_throw_type_error(env, nullptr, "Expected (data, outputPath[, options])");
+        return nullptr;
+    }
+    fastqr::QROptions options = object_to_options(env, argc > 2 ? argv[2] : nullptr);
+
+    napi_value result;
+    NAPI_CALL(env, napi_get_boolean(env, fastqr::generate(data, output_path, options), &result));
+    return result;
+}
+
+// generateBuffer(data, options) -> Buffer
+static napi_value GenerateBuffer(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+
+    std::string data;
+    if (argc < 1 || !get_string(env, argv[0], data)) {
+        napi_throw_type_error(env, nullptr, "Expected (data[, options])");
+        return nullptr;
+    }
+    fastqr::QROptions options = object_to_options(env, argc > 1 ? argv[1] : nullptr);
+
+    std::vector<uint8_t> png;
+    if (!fastqr::generate_to_buffer(data, png, options)) {
+        napi_throw_error(env, nullptr, "Failed to generate QR code");
+        return nullptr;
+    }
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_buffer_copy(env, png.size(), png.data(), nullptr, &result));
+    return result;
+}
+
+// Arguments of generateBatch / generateBatchAsync
+struct BatchArgs {
+    std::vector<std::string> data_list;
+    std::string output_dir;
+    fastqr::QROptions options;
+    int threads = 0;
+};
+
+// Read (dataArray, outputDir[, options[, threads]]); throws and returns false on bad arguments
+static bool get_batch_args(napi_env env, napi_callback_info info, BatchArgs& args) {
+    size_t argc = 4;
+    napi_value argv[4];
+    bool is_array = false;
+    uint32_t length = 0;
+    if (napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr) != napi_ok || argc < 2 ||
+        napi_is_array(env, argv[0], &is_array) != napi_ok || !is_array ||
+        napi_get_array_length(env, argv[0], &length) != napi_ok || !get_string(env, argv[1], args.output_dir)) {
+        napi_throw_type_error(env, nullptr, "Expected (dataArray, outputDir[, options[, threads]])");
+        return false;
+    }
+
+    args.data_list.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value item;
+        if (napi_get_element(env, argv[0], i, &item) != napi_ok || !get_string(env, item, args.data_list[i])) {
+            napi_throw_type_error(env, nullptr, "Data array must contain strings");
+            return false;
+        }
+    }
+
+    args.options = object_to_options(env, argc > 2 ? argv[2] : nullptr);
+    if (argc > 3) {
+        napi_get_value_int32(env, argv[3], &args.threads);
+    }
+    return true;
+}
+
+static napi_value batch_result(napi_env env, const fastqr::BatchResult& batch) {
+    napi_value result, success, failed;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_create_uint32(env, static_cast<uint32_t>(batch.success_count), &success));
+    NAPI_CALL(env, napi_create_uint32(env, static_cast<uint32_t>(batch.fail_count), &failed));
+    NAPI_CALL(env, napi_set_named_property(env, result, "success", success));
+    NAPI_CALL(env, napi_set_named_property(env, result, "failed", failed));
+    return result;
+}
+
+// State for a generate*Async call running on the libuv threadpool
+struct AsyncJob {
+    napi_async_work work = nullptr;
+    napi_deferred deferred = nullptr;
+    std::string data;
+    std::string output_path;   // Empty = return a Buffer
+    fastqr::QROptions options;
+    std::vector<uint8_t> png;
+    bool ok = false;
+    bool is_batch = false;     // generateBatchAsync: `batch_args` in, `batch` out
+    BatchArgs batch_args;
+    fastqr::BatchResult batch;
+};
+
+static void execute_job(napi_env, void* arg) {
+    // Runs off the main thread - must not touch any napi_value
+    AsyncJob* job = static_cast<AsyncJob*>(arg);
+    if (job->is_batch) {
+        const BatchArgs& args = job->batch_args;
+        job->batch = fastqr::generate_batch(args.data_list, args.output_dir, args.options, args.threads);
+        job->ok = true;  // Per-item failures are reported in the counts
+    } else if (job->output_path.empty()) {
+        job->ok = fastqr::generate_to_buffer(job->data, job->png, job->options);
+    } else {
+        job->ok = fastqr::generate(job->data, job->output_path, job->options);
+    }
+}
+
+static void complete_job(napi_env env, napi_status status, void* arg) {
+    AsyncJob* job = static_cast<AsyncJob*>(arg);
+    napi_value value = nullptr;
+
+    if (status == napi_ok && job->ok) {
+        if (job->is_batch) {
+            value = batch_result(env, job->batch);
+        } else if (job->output_path.empty()) {
+            napi_create_buffer_copy(env, job->png.size(), job->png.data(), nullptr, &value);
+        } else {
+            napi_get_boolean(env, true, &value);
+        }
+        napi_resolve_deferred(env, job->deferred, value);
+    } else {
+        napi_value message;
+        napi_create_string_utf8(env, "Failed to generate QR code", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &value);
+        napi_reject_deferred(env, job->deferred, value);
+    }
+
+    napi_delete_async_work(env, job->work);
+    delete job;
+}
+
+static napi_value queue_job(napi_env env, AsyncJob* job) {
+    napi_value promise, name;
+    if (napi_create_promise(env, &job->deferred, &promise) != napi_ok ||
+        napi_create_string_utf8(env, "fastqr", NAPI_AUTO_LENGTH, &name) != napi_ok ||
+        napi_create_async_work(env, nullptr, name, execute_job, complete_job, job, &job->work) != napi_ok ||
+        napi_queue_async_work(env, job->work) != napi_ok) {
+        delete job;
+        napi_throw_error(env, nullptr, "Failed to queue QR generation");
+        return nullptr;
+    }
+    return promise;
+}
+
+// generateAsync(data, outputPath, options) -> Promise<boolean>
+static napi_value GenerateAsync(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+
+    AsyncJob* job = new AsyncJob();
+    if (argc < 2 || !get_string(env, argv[0], job->data) || !get_string(env, argv[1], job->output_path) ||
+        job->output_path.empty()) {
+        delete job;
+        napi_throw_type_error(env, nullptr, "Expected (data, outputPath[, options])");
+        return nullptr;
+    }
+    job->options = object_to_options(env, argc > 2 ? argv[2] : nullptr);
+    return queue_job(env, job);
+}
+
+// generateBufferAsync(data, options) -> Promise<Buffer>
+static napi_value GenerateBufferAsync(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+
+    AsyncJob* job = new AsyncJob();
+    if (argc < 1 || !get_string(env, argv[0], job->data)) {
+        delete job;
+        napi_throw_type_error(env, nullptr, "Expected (data[, options])");
+        return nullptr;
+    }
+    job->options = object_to_options(env, argc > 1 ? argv[1] : nullptr);
+    return queue_job(env, job);
+}
+
+// generateBatch(dataArray, outputDir, options, threads) -> { success, failed }
+static napi_value GenerateBatch(napi_env env, napi_callback_info info) {
+    BatchArgs args;
+    if (!get_batch_args(env, info, args)) {
+        return nullptr;
+    }
+    return batch_result(env, fastqr::generate_batch(args.data_list, args.output_dir, args.options, args.threads));
+}
+
+// generateBatchAsync(dataArray, outputDir, options, threads) -> Promise<{ success, failed }>
+static napi_value GenerateBatchAsync(napi_env env, napi_callback_info info) {
+    AsyncJob* job = new AsyncJob();
+    job->is_batch = true;
+    if (!get_batch_args(env, info, job->batch_args)) {
+        delete job;
+        return nullptr;
+    }
+    return queue_job(env, job);
+}
+
+// version() -> string
+static napi_value Version(napi_env env, napi_callback_info) {
+    napi_value result;
+    NAPI_CALL(env, napi_create_string_utf8(env, fastqr::version(), NAPI_AUTO_LENGTH, &result));
+    return result;
+}
+
+static napi_value Init(napi_env env, napi_value exports) {
+    napi_property_descriptor props[] = {
+        {"generate", nullptr, Generate, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"generateBuffer", nullptr, GenerateBuffer, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"generateAsync", nullptr, GenerateAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"generateBufferAsync", nullptr, GenerateBufferAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"generateBatch", nullptr, GenerateBatch, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"generateBatchAsync", nullptr, GenerateBatchAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"version", nullptr, Version, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+    NAPI_CALL(env, napi_define_properties(env, exports, sizeof(props) / sizeof(props[0]), props));
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -57,6 +57,20 @@ export interface QROptions {
 
     /** Output format: 'png', 'jpg', 'webp' (default: 'png') */
     format?: 'png' | 'jpg' | 'jpeg' | 'webp';
+
+    /** Margin (quiet zone) in pixels (default: 0) */
+    margin?: number;
+
+    /** Margin in modules (default: 4, ISO standard) */
+    marginModules?: number;
+
+    /** Worker threads for generateBatch (default: 0 = all cores, native addon only) */
+    threads?: number;
+}
+
+export interface BatchResult {
+    success: number;
+    failed: number;
 }
 
 /**
@@ -85,6 +99,50 @@ export interface QROptions {
  */
 export function generate(data: string, outputPath: string, options?: QROptions): boolean;
 
+/**
+ * Generate QR code and return PNG bytes (no file written)
+ * @param data - Data to encode (UTF-8 supported)
+ * @param options - Generation options
+ * @returns PNG image data
+ */
+export function generateBuffer(data: string, options?: QROptions): Buffer;
+
+/**
+ * Generate QR code without blocking the event loop (runs on the libuv threadpool)
+ * @param data - Data to encode (UTF-8 supported)
+ * @param outputPath - Path to save the QR code image
+ * @param options - Generation options
+ * @returns Promise resolving to true when the file is written
+ */
+export function generateAsync(data: string, outputPath: string, options?: QROptions): Promise<boolean>;
+
+/**
+ * Generate QR code PNG bytes without blocking the event loop
+ * @param data - Data to encode (UTF-8 supported)
+ * @param options - Generation options
+ * @returns Promise resolving to PNG image data
+ */
+export function generateBufferAsync(data: string, options?: QROptions): Promise<Buffer>;
+
+/**
+ * Generate multiple QR codes in batch mode
+ * @param dataArray - Array of strings to encode
+ * @param outputDir - Directory to save QR codes (created if missing)
+ * @param options - Generation options (same as generate)
+ * @returns Success and failed counts
+ */
+export function generateBatch(dataArray: string[], outputDir: string, options?: QROptions): BatchResult;
+
+/**
+ * Generate multiple QR codes without blocking the event loop (the batch
+ * runs on the libuv threadpool)
+ * @param dataArray - Array of strings to encode
+ * @param outputDir - Directory to save QR codes (created if missing)
+ * @param options - Generation options (same as generate)
+ * @returns Promise resolving to the success and failed counts
+ */
+export function generateBatchAsync(dataArray: string[], outputDir: string, options?: QROptions): Promise<BatchResult>;
+
 /**
  * Get library version
  * @returns Version string
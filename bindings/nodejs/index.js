@@ -19,14 +19,90 @@
  */
 
 const platform = require('./lib/platform');
-const { execFileSync } = require('child_process');
+const { execFileSync, execFile } = require('child_process');
 const fs = require('fs');
+const os = require('os');
 const path = require('path');
 
 let fastqr;
 
-// Use pre-built CLI binary (no FFI needed!)
-if (platform.isPrebuiltAvailable()) {
+/**
+ * Load the native N-API addon (links libfastqr directly - no process spawn)
+ * @returns {Object|null} Addon exports, or null if not built for this platform
+ */
+function loadNativeAddon() {
+  const candidates = [
+    path.join(__dirname, 'build', 'Release', 'fastqr.node')
+  ];
+  try {
+    candidates.push(path.join(__dirname, 'prebuilt', platform.getPlatformString(), 'fastqr.node'));
+  } catch (error) {
+    // Unsupported platform - only a locally built addon can work
+  }
+
+  for (const candidate of candidates) {
+    if (!fs.existsSync(candidate)) continue;
+    try {
+      return require(candidate);
+    } catch (error) {
+      // Built for another Node ABI or missing shared libs - try next
+    }
+  }
+  return null;
+}
+
+/**
+ * Convert options to CLI arguments
+ * @param {QROptions} options
+ * @returns {string[]}
+ */
+function cliArgs(options) {
+  const args = [];
+
+  // Support both new 'size' and legacy 'width'/'height'
+  const size = options.size || options.width || options.height || 300;
+  args.push('-s', size.toString());
+
+  if (options.optimizeSize) args.push('-o');
+  if (options.foreground) args.push('-f', options.foreground.join(','));
+  if (options.background) args.push('-b', options.background.join(','));
+  if (options.errorLevel) args.push('-e', options.errorLevel);
+  if (options.logo) args.push('-l', options.logo);
+  if (options.logoSize) args.push('-p', options.logoSize.toString());
+  if (options.quality) args.push('-q', options.quality.toString());
+  if (options.margin !== undefined) {
+    args.push('-m', options.margin.toString());
+  } else if (options.marginModules !== undefined) {
+    args.push('--margin-modules', options.marginModules.toString());
+  }
+  return args;
+}
+
+/**
+ * Temporary PNG path for CLI fallback of buffer functions
+ * @returns {string}
+ */
+function tempPngPath() {
+  return path.join(os.tmpdir(), `fastqr_${process.pid}_${Date.now()}_${Math.random().toString(36).slice(2)}.png`);
+}
+
+const native = loadNativeAddon();
+
+if (native) {
+  // Native addon: in-process encoding, async variants run on the libuv threadpool
+  fastqr = {
+    generate: native.generate,
+    generateBuffer: native.generateBuffer,
+    generateAsync: native.generateAsync,
+    generateBufferAsync: native.generateBufferAsync,
+    generateBatch: native.generateBatch,
+    generateBatchAsync: native.generateBatchAsync,
+    version: native.version,
+    isNative: true,
+    VERSION: native.version()
+  };
+} else if (platform.isPrebuiltAvailable()) {
+  // Fallback: pre-built CLI binary
   const cliPath = path.join(__dirname, 'prebuilt', platform.getPlatformString(), 'bin', 'fastqr');
 
   if (!fs.existsSync(cliPath)) {
@@ -39,32 +115,40 @@ if (platform.isPrebuiltAvailable()) {
   // Wrap CLI to match API interface
   fastqr = {
     generate: function(data, outputPath, options = {}) {
-      const args = [data, outputPath];
-
-      // Support both new 'size' and legacy 'width'/'height'
-      const size = options.size || options.width || options.height || 300;
-      args.push('-s', size.toString());
-
-      if (options.optimizeSize) args.push('-o');
-      if (options.foreground) args.push('-f', options.foreground.join(','));
-      if (options.background) args.push('-b', options.background.join(','));
-      if (options.errorLevel) args.push('-e', options.errorLevel);
-      if (options.logo) args.push('-l', options.logo);
-      if (options.logoSize) args.push('-p', options.logoSize.toString());
-      if (options.quality) args.push('-q', options.quality.toString());
-      if (options.margin !== undefined) {
-        args.push('-m', options.margin.toString());
-      } else if (options.marginModules !== undefined) {
-        args.push('--margin-modules', options.marginModules.toString());
-      }
-
       try {
-        execFileSync(cliPath, args, { stdio: 'pipe' });
+        execFileSync(cliPath, [data, outputPath, ...cliArgs(options)], { stdio: 'pipe' });
         return true;
       } catch (error) {
         return false;
       }
     },
+    generateBuffer: function(data, options = {}) {
+      const tempFile = tempPngPath();
+      try {
+        if (!fastqr.generate(data, tempFile, options)) {
+          throw new Error('Failed to generate QR code');
+        }
+        return fs.readFileSync(tempFile);
+      } finally {
+        if (fs.existsSync(tempFile)) fs.unlinkSync(tempFile);
+      }
+    },
+    generateAsync: function(data, outputPath, options = {}) {
+      return new Promise((resolve, reject) => {
+        execFile(cliPath, [data, outputPath, ...cliArgs(options)], (error) => {
+          if (error) reject(new Error('Failed to generate QR code'));
+          else resolve(true);
+        });
+      });
+    },
+    generateBufferAsync: function(data, options = {}) {
+      const tempFile = tempPngPath();
+      return fastqr.generateAsync(data, tempFile, options)
+        .then(() => fs.promises.readFile(tempFile))
+        .finally(() => fs.promises.unlink(tempFile).catch(() => {}));
+    },
+    generateBatch: null,  // CLI batch mode is used instead (see generateBatch below)
+    generateBatchAsync: null,
     version: function() {
       try {
         const output = execFileSync(cliPath, ['-v'], { encoding: 'utf8' });
@@ -73,6 +157,7 @@ if (platform.isPrebuiltAvailable()) {
         return 'unknown';
       }
     },
+    isNative: false,
     VERSION: null  // Will be set below
   };
 
@@ -100,6 +185,7 @@ if (platform.isPrebuiltAvailable()) {
  * @property {string} [format='png'] - Output format: 'png', 'jpg', 'webp'
  * @property {number} [margin=0] - Margin (quiet zone) in pixels (absolute)
  * @property {number} [marginModules=4] - Margin in modules (relative, ISO standard)
+ * @property {number} [threads=0] - Worker threads for generateBatch (0 = all cores, native addon only)
  */
 
 /**
@@ -150,6 +236,60 @@ function generate(data, outputPath, options = {}) {
     return result;
 }
 
+/**
+ * Validate data/options arguments shared by the buffer functions
+ * @param {string} data
+ */
+function checkData(data) {
+    if (!data || typeof data !== 'string') {
+        throw new TypeError('Data must be a non-empty string');
+    }
+}
+
+/**
+ * Generate QR code and return PNG bytes (no file written)
+ * @param {string} data - Data to encode (UTF-8 supported)
+ * @param {QROptions} [options={}] - Generation options
+ * @returns {Buffer} PNG image data
+ *
+ * @example
+ * const png = fastqr.generateBuffer('Hello', { size: 500 });
+ * res.type('png').send(png);
+ */
+function generateBuffer(data, options = {}) {
+    checkData(data);
+    return fastqr.generateBuffer(data, options);
+}
+
+/**
+ * Generate QR code without blocking the event loop
+ * @param {string} data - Data to encode (UTF-8 supported)
+ * @param {string} outputPath - Path to save the QR code image
+ * @param {QROptions} [options={}] - Generation options
+ * @returns {Promise<boolean>} Resolves to true when the file is written
+ */
+function generateAsync(data, outputPath, options = {}) {
+    checkData(data);
+    if (!outputPath || typeof outputPath !== 'string') {
+        throw new TypeError('Output path must be a non-empty string');
+    }
+    return fastqr.generateAsync(data, outputPath, options);
+}
+
+/**
+ * Generate QR code PNG bytes without blocking the event loop
+ * @param {string} data - Data to encode (UTF-8 supported)
+ * @param {QROptions} [options={}] - Generation options
+ * @returns {Promise<Buffer>} PNG image data
+ *
+ * @example
+ * const png = await fastqr.generateBufferAsync('Hello', { size: 500 });
+ */
+function generateBufferAsync(data, options = {}) {
+    checkData(data);
+    return fastqr.generateBufferAsync(data, options);
+}
+
 /**
  * Get library version
  * @returns {string} Version string
@@ -174,6 +314,58 @@ function version() {
  * // Creates: output_dir/1.png, output_dir/2.png, output_dir/3.png
  */
 function generateBatch(dataArray, outputDir, options = {}) {
+    checkBatchArgs(dataArray, outputDir);
+
+    // Native addon: parallel in-process generation
+    if (fastqr.generateBatch) {
+        return fastqr.generateBatch(dataArray, outputDir, options, options.threads || 0);
+    }
+
+    const batch = cliBatch(dataArray, outputDir, options);
+    try {
+        execFileSync(batch.cliPath, batch.args, { stdio: 'pipe' });
+        return { success: dataArray.length, failed: 0 };
+    } catch (error) {
+        throw new Error(`Batch generation failed: ${error.message}`);
+    } finally {
+        batch.cleanup();
+    }
+}
+
+/**
+ * Generate multiple QR codes without blocking the event loop
+ * @param {string[]} dataArray - Array of strings to encode
+ * @param {string} outputDir - Directory to save QR codes (will be created if it doesn't exist)
+ * @param {QROptions} [options={}] - Generation options (same as generate)
+ * @returns {Promise<Object>} Resolves to the success and failed counts
+ *
+ * @example
+ * const result = await fastqr.generateBatchAsync(['QR 1', 'QR 2'], 'output_dir/', { size: 500 });
+ */
+function generateBatchAsync(dataArray, outputDir, options = {}) {
+    checkBatchArgs(dataArray, outputDir);
+
+    // Native addon: the whole batch runs on the libuv threadpool
+    if (fastqr.generateBatchAsync) {
+        return fastqr.generateBatchAsync(dataArray, outputDir, options, options.threads || 0);
+    }
+
+    const batch = cliBatch(dataArray, outputDir, options);
+    return new Promise((resolve, reject) => {
+        execFile(batch.cliPath, batch.args, (error) => {
+            batch.cleanup();
+            if (error) reject(new Error(`Batch generation failed: ${error.message}`));
+            else resolve({ success: dataArray.length, failed: 0 });
+        });
+    });
+}
+
+/**
+ * Validate generateBatch arguments and create the output directory
+ * @param {string[]} dataArray
+ * @param {string} outputDir
+ */
+function checkBatchArgs(dataArray, outputDir) {
     if (!Array.isArray(dataArray) || dataArray.length === 0) {
         throw new TypeError('Data array must be a non-empty array');
     }
@@ -181,55 +373,38 @@ function generateBatch(dataArray, outputDir, options = {}) {
         throw new TypeError('Output directory must be a non-empty string');
     }
 
-    const fs = require('fs');
-    const { execFileSync } = require('child_process');
-    const os = require('os');
-    const path = require('path');
-
     // Create output directory
     if (!fs.existsSync(outputDir)) {
         fs.mkdirSync(outputDir, { recursive: true });
     }
+}
 
-    // Create temporary batch file
-    const tempFile = path.join(os.tmpdir(), `fastqr_batch_${Date.now()}.txt`);
-    try {
-        fs.writeFileSync(tempFile, dataArray.join('\n'), 'utf8');
-
-        // Get CLI path
-        const cliPath = path.join(__dirname, 'prebuilt', platform.getPlatformString(), 'bin', 'fastqr');
-
-        // Build command arguments
-        const args = ['-F', tempFile, outputDir];
-        if (options.size) args.push('-s', options.size.toString());
-        if (options.optimizeSize) args.push('-o');
-        if (options.foreground) args.push('-f', options.foreground.join(','));
-        if (options.background) args.push('-b', options.background.join(','));
-        if (options.errorLevel) args.push('-e', options.errorLevel);
-        if (options.logo) args.push('-l', options.logo);
-        if (options.logoSize) args.push('-p', options.logoSize.toString());
-        if (options.quality) args.push('-q', options.quality.toString());
-        if (options.margin !== undefined) {
-          args.push('-m', options.margin.toString());
-        } else if (options.marginModules !== undefined) {
-          args.push('--margin-modules', options.marginModules.toString());
-        }
-
-        execFileSync(cliPath, args, { stdio: 'pipe' });
-
-        return { success: dataArray.length, failed: 0 };
-    } catch (error) {
-        throw new Error(`Batch generation failed: ${error.message}`);
-    } finally {
-        if (fs.existsSync(tempFile)) {
-            fs.unlinkSync(tempFile);
+/**
+ * CLI batch-mode invocation for the fallback path: writes the batch file
+ * @param {string[]} dataArray
+ * @param {string} outputDir
+ * @param {QROptions} options
+ * @returns {{cliPath: string, args: string[], cleanup: Function}}
+ */
+function cliBatch(dataArray, outputDir, options) {
+    const tempFile = path.join(os.tmpdir(), `fastqr_batch_${process.pid}_${Date.now()}_${Math.random().toString(36).slice(2)}.txt`);
+    fs.writeFileSync(tempFile, dataArray.join('\n'), 'utf8');
+    return {
+        cliPath: path.join(__dirname, 'prebuilt', platform.getPlatformString(), 'bin', 'fastqr'),
+        args: ['-F', tempFile, outputDir, ...cliArgs(options)],
+        cleanup: () => {
+            if (fs.existsSync(tempFile)) fs.unlinkSync(tempFile);
         }
-    }
+    };
 }
 
 module.exports = {
     generate,
+    generateBuffer,
+    generateAsync,
+    generateBufferAsync,
     generateBatch,
+    generateBatchAsync,
     version,
     VERSION: fastqr.VERSION
 };
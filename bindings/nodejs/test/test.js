@@ -18,7 +18,8 @@
  * Homepage: https://github.com/tranhuucanh/fastqr
  */
 
-const fastqr = require('./index');
+const fastqr = require('../index');
+const fs = require('fs');
 
 console.log('FastQR Node.js Test');
 console.log('Version:', fastqr.version());
@@ -57,9 +58,37 @@ try {
     });
     console.log('✓ Generated test_japanese.png');
 
-    console.log('\n✓ All tests passed!');
+    // In-memory PNG
+    console.log('\nTest 5: Buffer output...');
+    const png = fastqr.generateBuffer('Buffer QR', { size: 300 });
+    if (!Buffer.isBuffer(png) || png.toString('latin1', 1, 4) !== 'PNG') {
+        throw new Error('generateBuffer did not return PNG data');
+    }
+    console.log('✓ Generated ' + png.length + ' bytes in memory');
 } catch (error) {
     console.error('✗ Test failed:', error.message);
     process.exit(1);
 }
 
+// Async (Promise) API
+console.log('\nTest 6: Async buffer output...');
+Promise.all([
+    fastqr.generateBufferAsync('Async QR 1', { size: 300 }),
+    fastqr.generateBufferAsync('Async QR 2', { size: 300 }),
+    fastqr.generateAsync('Async file', 'test_async.png'),
+    fastqr.generateBatchAsync(['Async batch 1', 'Async batch 2'], 'test_batch_async', { size: 200 })
+]).then(([png1, png2, , batch]) => {
+    if (!Buffer.isBuffer(png1) || !Buffer.isBuffer(png2)) {
+        throw new Error('generateBufferAsync did not resolve to a Buffer');
+    }
+    if (batch.success !== 2 || !fs.existsSync('test_batch_async/2.png')) {
+        throw new Error('generateBatchAsync did not write the batch');
+    }
+    fs.rmSync('test_batch_async', { recursive: true, force: true });
+    console.log('✓ Generated async buffers, test_async.png and an async batch');
+    console.log('\n✓ All tests passed!');
+}).catch((error) => {
+    console.error('✗ Test failed:', error.message);
+    process.exit(1);
+});
+
@@ -28,16 +28,91 @@ class FastQR
 {
     private static ?string $cliPath = null;
 
+    /** @var \FFI|false|null FFI handle, false once loading failed */
+    private static $ffi = null;
+
     /**
-     * Find CLI binary
+     * C declarations from include/fastqr.h used over FFI
      */
-    private static function findBinary(): string
+    private const CDEF = <<<'CDEF'
+typedef struct {
+    int size;
+    int optimize_size;
+    unsigned char foreground_r;
+    unsigned char foreground_g;
+    unsigned char foreground_b;
+    unsigned char background_r;
+    unsigned char background_g;
+    unsigned char background_b;
+    int ec_level;
+    const char* logo_path;
+    int logo_size_percent;
+    const char* format;
+    int quality;
+    int margin;
+    int margin_modules;
+} QROptions;
+int fastqr_generate(const char* data, const char* output_path, const QROptions* options);
+unsigned char* fastqr_generate_buffer(const char* data, const QROptions* options, size_t* size);
+void fastqr_free_buffer(unsigned char* buffer);
+const char* fastqr_version(void);
+CDEF;
+
+    /**
+     * Load libfastqr over FFI (in-process, no process spawned per QR code)
+     *
+     * Searched in FASTQR_LIBRARY, the pre-built lib directory and system paths.
+     *
+     * @return \FFI|null null if ext-ffi or the shared library is unavailable
+     */
+    private static function loadFFI(): ?\FFI
     {
-        if (self::$cliPath !== null) {
-            return self::$cliPath;
+        if (self::$ffi !== null) {
+            return self::$ffi ?: null;
         }
+        self::$ffi = false;
 
-        // Detect platform
+        if (!extension_loaded('ffi')) {
+            return null;
+        }
+
+        $libName = PHP_OS_FAMILY === 'Darwin' ? 'libfastqr.dylib' : 'libfastqr.so';
+        $libraryPaths = array_filter([
+            getenv('FASTQR_LIBRARY') ?: null,
+            __DIR__ . '/../../prebuilt/' . self::platform() . "/lib/$libName",
+            "/usr/local/lib/$libName",
+            "/opt/homebrew/lib/$libName",
+            "/usr/lib/$libName",
+        ]);
+
+        foreach ($libraryPaths as $path) {
+            if (!file_exists($path)) {
+                continue;
+            }
+            try {
+                self::$ffi = \FFI::cdef(self::CDEF, $path);
+                return self::$ffi;
+            } catch (\Throwable $e) {
+                // Wrong architecture, missing dependencies or FFI disabled - try next
+            }
+        }
+
+        return null;
+    }
+
+    /**
+     * Whether QR codes are generated in-process through FFI
+     */
+    public static function isNative(): bool
+    {
+        return self::loadFFI() !== null;
+    }
+
+    /**
+     * Detect platform string (e.g. 'linux-x86_64', 'macos-arm64')
+     */
+    private static function platform(): string
+    {
         $os = PHP_OS_FAMILY === 'Darwin' ? 'macos' : (PHP_OS_FAMILY === 'Linux' ? 'linux' : 'unknown');
         $arch = php_uname('m');
         if ($arch === 'x86_64' || $arch === 'amd64') {
@@ -45,7 +120,101 @@ class FastQR
         } elseif ($arch === 'aarch64' || $arch === 'arm64') {
             $arch = $os === 'macos' ? 'arm64' : 'aarch64';
         }
-        $platform = "$os-$arch";
+        return "$os-$arch";
+    }
+
+    /**
+     * Build a C QROptions struct from an options array
+     *
+     * @param array $keepAlive Receives C strings referenced by the struct;
+     *                         must stay in scope until the call returns
+     */
+    private static function ffiOptions(\FFI $ffi, array $options, array &$keepAlive): \FFI\CData
+    {
+        $opts = $ffi->new('QROptions');
+
+        // Defaults (same as fastqr::QROptions)
+        $opts->size = 300;
+        $opts->optimize_size = 0;
+        $opts->foreground_r = $opts->foreground_g = $opts->foreground_b = 0;
+        $opts->background_r = $opts->background_g = $opts->background_b = 255;
+        $opts->ec_level = 1;
+        $opts->logo_path = null;
+        $opts->logo_size_percent = 20;
+        $opts->format = null;
+        $opts->quality = 95;
+        $opts->margin = 0;
+        $opts->margin_modules = 4;
+
+        // Size (preferred) or width/height (backward compatibility)
+        if (isset($options['size'])) {
+            $opts->size = (int)$options['size'];
+        } elseif (isset($options['width']) || isset($options['height'])) {
+            $opts->size = (int)($options['width'] ?? $options['height']);
+        }
+        $opts->optimize_size = empty($options['optimizeSize']) ? 0 : 1;
+
+        if (isset($options['foreground'])) {
+            [$opts->foreground_r, $opts->foreground_g, $opts->foreground_b] = array_map('intval', $options['foreground']);
+        }
+        if (isset($options['background'])) {
+            [$opts->background_r, $opts->background_g, $opts->background_b] = array_map('intval', $options['background']);
+        }
+
+        if (isset($options['errorLevel'])) {
+            $levels = ['L' => 0, 'M' => 1, 'Q' => 2, 'H' => 3];
+            $opts->ec_level = $levels[$options['errorLevel']] ?? 1;
+        }
+
+        if (isset($options['logo'])) {
+            $opts->logo_path = self::cString($ffi, (string)$options['logo'], $keepAlive);
+        }
+        if (isset($options['logoSize'])) {
+            $opts->logo_size_percent = (int)$options['logoSize'];
+        }
+        if (isset($options['format'])) {
+            $opts->format = self::cString($ffi, (string)$options['format'], $keepAlive);
+        }
+        if (isset($options['quality'])) {
+            $opts->quality = (int)$options['quality'];
+        }
+
+        // Margin options (margin takes priority, same as the CLI path)
+        if (isset($options['margin'])) {
+            $opts->margin = (int)$options['margin'];
+            $opts->margin_modules = 0;
+        } elseif (isset($options['marginModules'])) {
+            $opts->margin_modules = (int)$options['marginModules'];
+        }
+
+        return $opts;
+    }
+
+    /**
+     * Copy a PHP string into a NUL-terminated C string
+     */
+    private static function cString(\FFI $ffi, string $value, array &$keepAlive): \FFI\CData
+    {
+        $length = strlen($value);
+        $buffer = $ffi->new('char[' . ($length + 1) . ']');
+        \FFI::memcpy($buffer, $value, $length);
+        $buffer[$length] = "\0";
+        $keepAlive[] = $buffer;
+        return $ffi->cast('char*', \FFI::addr($buffer));
+    }
+
+    /**
+     * Find CLI binary
+     */
+    private static function findBinary(): string
+    {
+        if (self::$cliPath !== null) {
+            return self::$cliPath;
+        }
+
+        // Detect platform
+        $os = PHP_OS_FAMILY === 'Darwin' ? 'macos' : (PHP_OS_FAMILY === 'Linux' ? 'linux' : 'unknown');
+        $platform = self::platform();
 
         // Try to find the binary (pre-built first, then system)
         $binaryPaths = [
@@ -131,6 +300,16 @@ class FastQR
             throw new RuntimeException('Output path cannot be empty');
         }
 
+        $ffi = self::loadFFI();
+        if ($ffi !== null) {
+            $keepAlive = [];
+            $opts = self::ffiOptions($ffi, $options, $keepAlive);
+            if (!$ffi->fastqr_generate($data, $outputPath, \FFI::addr($opts))) {
+                throw new RuntimeException('Failed to generate QR code');
+            }
+            return true;
+        }
+
         $cliPath = self::findBinary();
 
         // Build command arguments
@@ -201,6 +380,59 @@ class FastQR
         return true;
     }
 
+    /**
+     * Generate QR code and return the PNG bytes (no file written)
+     *
+     * @param string $data Data to encode (UTF-8 supported)
+     * @param array $options Generation options (same as generate)
+     * @return string PNG image data
+     *
+     * @throws RuntimeException if generation fails
+     *
+     * @example
+     * ```php
+     * header('Content-Type: image/png');
+     * echo FastQR::generateBuffer('Hello', ['size' => 500]);
+     * ```
+     */
+    public static function generateBuffer(string $data, array $options = []): string
+    {
+        if (empty($data)) {
+            throw new RuntimeException('Data cannot be empty');
+        }
+
+        $ffi = self::loadFFI();
+        if ($ffi !== null) {
+            $keepAlive = [];
+            $opts = self::ffiOptions($ffi, $options, $keepAlive);
+            $size = $ffi->new('size_t');
+            $buffer = $ffi->fastqr_generate_buffer($data, \FFI::addr($opts), \FFI::addr($size));
+            if ($buffer === null || \FFI::isNull($buffer)) {
+                throw new RuntimeException('Failed to generate QR code');
+            }
+            try {
+                return \FFI::string($buffer, $size->cdata);
+            } finally {
+                $ffi->fastqr_free_buffer($buffer);
+            }
+        }
+
+        // CLI fallback through a temporary file (the one tempnam() creates;
+        // the CLI writes PNG whatever the extension)
+        $tempFile = tempnam(sys_get_temp_dir(), 'fastqr_');
+        if ($tempFile === false) {
+            throw new RuntimeException('Failed to create temporary file');
+        }
+        try {
+            self::generate($data, $tempFile, $options);
+            return file_get_contents($tempFile);
+        } finally {
+            if (file_exists($tempFile)) {
+                unlink($tempFile);
+            }
+        }
+    }
+
     /**
      * Get library version
      *
@@ -208,6 +440,11 @@ class FastQR
      */
     public static function version(): string
     {
+        $ffi = self::loadFFI();
+        if ($ffi !== null) {
+            return \FFI::string($ffi->fastqr_version());
+        }
+
         $cliPath = self::findBinary();
         $cmd = escapeshellarg($cliPath) . ' -v 2>&1';
         $output = shell_exec($cmd);
@@ -98,6 +98,17 @@ class FastQRTest extends TestCase
         $this->assertFileExists($output);
     }
 
+    public function testGenerateBuffer(): void
+    {
+        $png = FastQR::generateBuffer('Buffer QR', ['size' => 300]);
+
+        $this->assertStringStartsWith("\x89PNG", $png);
+
+        $output = $this->outputDir . '/buffer.png';
+        FastQR::generate('Buffer QR', $output, ['size' => 300]);
+        $this->assertSame(file_get_contents($output), $png);
+    }
+
     public function testEmptyDataThrowsException(): void
     {
         $this->expectException(\RuntimeException::class);
@@ -71,36 +71,29 @@ def check_prebuilt_binary
   false
 end
 
-# Try to use pre-built binary first
-exit 0 if check_prebuilt_binary
-
-# If no pre-built binary, compile from source
-puts "⚠️  No pre-built binary found, compiling from source..."
-
-# Check for required libraries
-unless have_library('qrencode')
-  abort "ERROR: libqrencode is required. Install it first."
+# Prefer the native extension: it runs in-process and releases the GVL,
+# so no process is spawned per QR code. Fall back to the pre-built CLI
+# binary when the libraries needed to compile it are missing.
+def native_dependencies_available?
+  have_library('png') && have_header('png.h')
 end
 
-unless have_library('png')
-  abort "ERROR: libpng is required. Install it first."
+unless native_dependencies_available?
+  exit 0 if check_prebuilt_binary
+  abort "ERROR: libpng (with headers) is required. Install it first."
 end
 
-# Check for headers
-unless have_header('qrencode.h')
-  abort "ERROR: qrencode.h not found"
-end
-
-unless have_header('png.h')
-  abort "ERROR: png.h not found"
-end
+puts "🔨 Compiling native extension..."
 
 # Add C++14 support
 $CXXFLAGS << " -std=c++14"
 
-# Set source directory
-$srcs = ['fastqr_ruby.cpp', '../../src/fastqr.cpp']
+# Worker threads for generate_batch
+have_library('pthread')
+
+# Set source directory (library sources are found through VPATH)
+$VPATH << "$(srcdir)/../../src"
+$srcs = ['fastqr_ruby.cpp', 'fastqr.cpp', 'batch.cpp', 'qr_encoder.cpp', 'reed_solomon.cpp', 'text_class.cpp', 'cache.cpp']
 $INCFLAGS << " -I$(srcdir)/../../include"
 
 create_makefile('fastqr/fastqr')
-
@@ -20,16 +20,16 @@
 
 #include "fastqr.h"
 #include <ruby.h>
+#include <ruby/thread.h>
 
 static VALUE rb_mFastQR;
-static VALUE rb_cQROptions;
-
-// Convert Ruby hash to QROptions
-static fastqr::QROptions hash_to_options(VALUE opts) {
-    fastqr::QROptions options;
+static VALUE rb_mNative;
 
+// Convert Ruby hash to QROptions. Raises on bad values, so it must run
+// under rb_protect (see read_args) with no C++ object of its own alive.
+static void hash_to_options(VALUE opts, fastqr::QROptions& options) {
     if (NIL_P(opts)) {
-        return options;
+        return;
     }
 
     VALUE val;
@@ -113,25 +113,162 @@ static fastqr::QROptions hash_to_options(VALUE opts) {
     if (!NIL_P(val)) {
         options.margin_modules = NUM2INT(val);
     }
+}
+
+// Arguments and result for work done without the GVL
+struct GenerateCall {
+    std::string data;
+    std::string output_path;
+    fastqr::QROptions options;
+    std::vector<uint8_t> png;
+    std::vector<std::string> data_list;
+    int threads = 0;
+    fastqr::BatchResult batch;
+    bool ok = false;
+};
+
+// These run without the GVL - they must not touch any Ruby object
+static void* generate_without_gvl(void* arg) {
+    GenerateCall* call = static_cast<GenerateCall*>(arg);
+    call->ok = fastqr::generate(call->data, call->output_path, call->options);
+    return nullptr;
+}
+
+static void* generate_buffer_without_gvl(void* arg) {
+    GenerateCall* call = static_cast<GenerateCall*>(arg);
+    call->ok = fastqr::generate_to_buffer(call->data, call->png, call->options);
+    return nullptr;
+}
+
+static void* generate_batch_without_gvl(void* arg) {
+    GenerateCall* call = static_cast<GenerateCall*>(arg);
+    call->batch = fastqr::generate_batch(call->data_list, call->output_path, call->options, call->threads);
+    return nullptr;
+}
+
+// Ruby arguments are converted under rb_protect: a raise (bad type,
+// NUL in a string, out-of-range number) longjmps, which would skip the
+// destructors of the C++ objects being filled. The GenerateCall lives in
+// the caller's frame instead, and the exception is re-raised with
+// rb_jump_tag only once that frame's C++ objects are gone.
+struct ReadArgs {
+    VALUE* argv;
+    GenerateCall* call;
+};
+
+static int read_args(VALUE (*reader)(VALUE), VALUE* argv, GenerateCall& call) {
+    ReadArgs args = {argv, &call};
+    int state = 0;
+    rb_protect(reader, reinterpret_cast<VALUE>(&args), &state);
+    return state;
+}
+
+static VALUE read_generate_args(VALUE arg) {
+    ReadArgs* args = reinterpret_cast<ReadArgs*>(arg);
+    args->call->data = StringValueCStr(args->argv[0]);
+    args->call->output_path = StringValueCStr(args->argv[1]);
+    hash_to_options(args->argv[2], args->call->options);
+    return Qnil;
+}
+
+static VALUE read_buffer_args(VALUE arg) {
+    ReadArgs* args = reinterpret_cast<ReadArgs*>(arg);
+    args->call->data = StringValueCStr(args->argv[0]);
+    hash_to_options(args->argv[1], args->call->options);
+    return Qnil;
+}
+
+static VALUE read_batch_args(VALUE arg) {
+    ReadArgs* args = reinterpret_cast<ReadArgs*>(arg);
+    VALUE data_array = args->argv[0];
+    Check_Type(data_array, T_ARRAY);
+    long length = RARRAY_LEN(data_array);
+    args->call->data_list.reserve(length);
+    for (long i = 0; i < length; i++) {
+        VALUE item = rb_ary_entry(data_array, i);
+        const char* str = StringValueCStr(item);
+        args->call->data_list.push_back(str);
+    }
+    args->call->output_path = StringValueCStr(args->argv[1]);
+    hash_to_options(args->argv[2], args->call->options);
+    args->call->threads = NIL_P(args->argv[3]) ? 0 : NUM2INT(args->argv[3]);
+    return Qnil;
+}
 
-    return options;
+static VALUE png_to_string(VALUE arg) {
+    const std::vector<uint8_t>* png = reinterpret_cast<const std::vector<uint8_t>*>(arg);
+    return rb_str_new(reinterpret_cast<const char*>(png->data()), static_cast<long>(png->size()));
 }
 
-// FastQR.generate(data, output_path, options = {})
+// FastQR::Native.generate(data, output_path, options = {})
 static VALUE rb_fastqr_generate(int argc, VALUE *argv, VALUE self) {
-    VALUE data, output_path, opts;
-    rb_scan_args(argc, argv, "21", &data, &output_path, &opts);
+    VALUE args[3];
+    rb_scan_args(argc, argv, "21", &args[0], &args[1], &args[2]);
 
-    std::string data_str = StringValueCStr(data);
-    std::string output_str = StringValueCStr(output_path);
-    fastqr::QROptions options = hash_to_options(opts);
+    bool ok = false;
+    int state;
+    {
+        GenerateCall call;
+        state = read_args(read_generate_args, args, call);
+        if (!state) {
+            // Release the GVL so other Ruby threads run while we encode
+            rb_thread_call_without_gvl(generate_without_gvl, &call, nullptr, nullptr);
+            ok = call.ok;
+        }
+    }
+    if (state) rb_jump_tag(state);
 
-    bool result = fastqr::generate(data_str, output_str, options);
+    return ok ? Qtrue : Qfalse;
+}
+
+// FastQR::Native.generate_buffer(data, options = {}) -> binary String or nil
+static VALUE rb_fastqr_generate_buffer(int argc, VALUE *argv, VALUE self) {
+    VALUE args[2];
+    rb_scan_args(argc, argv, "11", &args[0], &args[1]);
+
+    VALUE result = Qnil;
+    int state;
+    {
+        GenerateCall call;
+        state = read_args(read_buffer_args, args, call);
+        if (!state) {
+            rb_thread_call_without_gvl(generate_buffer_without_gvl, &call, nullptr, nullptr);
+            if (call.ok) {
+                result = rb_protect(png_to_string, reinterpret_cast<VALUE>(&call.png), &state);
+            }
+        }
+    }
+    if (state) rb_jump_tag(state);
 
-    return result ? Qtrue : Qfalse;
+    return result;
 }
 
-// FastQR.version
+// FastQR::Native.generate_batch(data_array, output_dir, options = {}, threads = 0)
+static VALUE rb_fastqr_generate_batch(int argc, VALUE *argv, VALUE self) {
+    VALUE args[4];
+    rb_scan_args(argc, argv, "22", &args[0], &args[1], &args[2], &args[3]);
+
+    size_t success = 0;
+    size_t failed = 0;
+    int state;
+    {
+        GenerateCall call;
+        state = read_args(read_batch_args, args, call);
+        if (!state) {
+            rb_thread_call_without_gvl(generate_batch_without_gvl, &call, nullptr, nullptr);
+            success = call.batch.success_count;
+            failed = call.batch.fail_count;
+        }
+    }
+    if (state) rb_jump_tag(state);
+
+    VALUE result = rb_hash_new();
+    rb_hash_aset(result, ID2SYM(rb_intern("success")), SIZET2NUM(success));
+    rb_hash_aset(result, ID2SYM(rb_intern("failed")), SIZET2NUM(failed));
+    return result;
+}
+
+// FastQR::Native.version
 static VALUE rb_fastqr_version(VALUE self) {
     return rb_str_new_cstr(fastqr::version());
 }
@@ -139,12 +276,15 @@ static VALUE rb_fastqr_version(VALUE self) {
 extern "C" void Init_fastqr() {
     rb_mFastQR = rb_define_module("FastQR");
 
-    rb_define_module_function(rb_mFastQR, "generate",
+    // Native entry points - FastQR (lib/fastqr.rb) dispatches to these
+    rb_mNative = rb_define_module_under(rb_mFastQR, "Native");
+
+    rb_define_module_function(rb_mNative, "generate",
                               RUBY_METHOD_FUNC(rb_fastqr_generate), -1);
-    rb_define_module_function(rb_mFastQR, "version",
+    rb_define_module_function(rb_mNative, "generate_buffer",
+                              RUBY_METHOD_FUNC(rb_fastqr_generate_buffer), -1);
+    rb_define_module_function(rb_mNative, "generate_batch",
+                              RUBY_METHOD_FUNC(rb_fastqr_generate_batch), -1);
+    rb_define_module_function(rb_mNative, "version",
                               RUBY_METHOD_FUNC(rb_fastqr_version), 0);
-
-    // Constants
-    rb_define_const(rb_mFastQR, "VERSION", rb_str_new_cstr(fastqr::version()));
 }
-
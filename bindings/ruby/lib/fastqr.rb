@@ -21,13 +21,30 @@
 require_relative "fastqr/version"
 require_relative "fastqr/platform"
 
+begin
+  # Native extension (compiled by extconf.rb when libpng is present)
+  require "fastqr/fastqr"
+rescue LoadError
+  # Not compiled - fall back to the pre-built CLI binary
+end
+
 module FastQR
   class Error < StandardError; end
 
+  # Whether the native extension is loaded (no process spawned per QR code,
+  # and encoding releases the GVL so threads can generate concurrently)
+  #
+  # @return [Boolean]
+  def self.native?
+    defined?(Native) ? true : false
+  end
+
   # Get library version
   #
   # @return [String] Version string
   def self.version
+    return Native.version if native?
+
     cli_path = Platform.find_binary
     output = `#{cli_path} -v 2>&1`.strip
     output.sub('FastQR v', '')
@@ -72,26 +89,14 @@ module FastQR
     raise Error, "Data cannot be empty" if data.nil? || data.empty?
     raise Error, "Output path cannot be empty" if output_path.nil? || output_path.empty?
 
-    cli_path = Platform.find_binary
-    args = [data, output_path]
-
-    # Build command arguments from options
-    args += ['-s', options[:size].to_s] if options[:size]
-    args += ['-o'] if options[:optimize_size]
-    args += ['-f', options[:foreground].join(',')] if options[:foreground]
-    args += ['-b', options[:background].join(',')] if options[:background]
-    args += ['-e', options[:error_level]] if options[:error_level]
-    args += ['-l', options[:logo]] if options[:logo]
-    args += ['-p', options[:logo_size].to_s] if options[:logo_size]
-    args += ['-q', options[:quality].to_s] if options[:quality]
-    
-    # Margin options (margin_modules takes priority over margin)
-    if options[:margin]
-      args += ['-m', options[:margin].to_s]
-    elsif options[:margin_modules]
-      args += ['--margin-modules', options[:margin_modules].to_s]
+    if native?
+      raise Error, "Failed to generate QR code" unless Native.generate(data, output_path, options)
+      return true
     end
 
+    cli_path = Platform.find_binary
+    args = [data, output_path] + cli_options(options)
+
     # Execute CLI binary
     result = system(cli_path, *args, out: File::NULL, err: File::NULL)
     raise Error, "Failed to generate QR code" unless result
@@ -99,11 +104,39 @@ module FastQR
     true
   end
 
+  # Generate QR code and return the PNG bytes (no file written)
+  #
+  # @param data [String] Data to encode (UTF-8 supported)
+  # @param options [Hash] Generation options (same as generate)
+  # @return [String] PNG image data (binary string)
+  #
+  # @example Serve from a Rails controller
+  #   send_data FastQR.generate_buffer("Hello", size: 500), type: "image/png", disposition: "inline"
+  def self.generate_buffer(data, options = {})
+    raise Error, "Data cannot be empty" if data.nil? || data.empty?
+
+    if native?
+      png = Native.generate_buffer(data, options)
+      raise Error, "Failed to generate QR code" if png.nil?
+      return png
+    end
+
+    require 'tempfile'
+    temp_file = Tempfile.new(['fastqr', '.png'])
+    begin
+      temp_file.close
+      generate(data, temp_file.path, options)
+      File.binread(temp_file.path)
+    ensure
+      temp_file.unlink
+    end
+  end
+
   # Generate multiple QR codes in batch mode (7x faster!)
   #
   # @param data_array [Array<String>] Array of strings to encode
   # @param output_dir [String] Directory to save QR codes (will be created if it doesn't exist)
-  # @param options [Hash] Generation options (same as generate)
+  # @param options [Hash] Generation options (same as generate, plus :threads - worker count, native only)
   # @return [Hash] Result with :success and :failed counts
   #
   # @example Batch generation
@@ -118,6 +151,9 @@ module FastQR
     require 'fileutils'
     FileUtils.mkdir_p(output_dir)
 
+    # Native extension: parallel in-process generation
+    return Native.generate_batch(data_array, output_dir, options, options[:threads] || 0) if native?
+
     # Create a temporary batch file
     require 'tempfile'
     temp_file = Tempfile.new(['fastqr_batch', '.txt'])
@@ -129,22 +165,7 @@ module FastQR
       cli_path = Platform.find_binary
 
       # Build command
-      cmd_parts = [cli_path, '-F', temp_file.path, output_dir]
-      cmd_parts += ['-s', options[:size].to_s] if options[:size]
-      cmd_parts += ['-o'] if options[:optimize_size]
-      cmd_parts += ['-f', options[:foreground].join(',')] if options[:foreground]
-      cmd_parts += ['-b', options[:background].join(',')] if options[:background]
-      cmd_parts += ['-e', options[:error_level]] if options[:error_level]
-      cmd_parts += ['-l', options[:logo]] if options[:logo]
-      cmd_parts += ['-p', options[:logo_size].to_s] if options[:logo_size]
-      cmd_parts += ['-q', options[:quality].to_s] if options[:quality]
-      
-      # Margin options (margin_modules takes priority over margin)
-      if options[:margin]
-        cmd_parts += ['-m', options[:margin].to_s]
-      elsif options[:margin_modules]
-        cmd_parts += ['--margin-modules', options[:margin_modules].to_s]
-      end
+      cmd_parts = [cli_path, '-F', temp_file.path, output_dir] + cli_options(options)
 
       result = system(*cmd_parts, out: File::NULL, err: File::NULL)
       raise Error, "Batch generation failed" unless result
@@ -154,5 +175,29 @@ module FastQR
       temp_file.unlink
     end
   end
-end
 
+  # Convert options hash to CLI arguments
+  #
+  # @param options [Hash] Generation options
+  # @return [Array<String>]
+  def self.cli_options(options)
+    args = []
+    args += ['-s', options[:size].to_s] if options[:size]
+    args += ['-o'] if options[:optimize_size]
+    args += ['-f', options[:foreground].join(',')] if options[:foreground]
+    args += ['-b', options[:background].join(',')] if options[:background]
+    args += ['-e', options[:error_level]] if options[:error_level]
+    args += ['-l', options[:logo]] if options[:logo]
+    args += ['-p', options[:logo_size].to_s] if options[:logo_size]
+    args += ['-q', options[:quality].to_s] if options[:quality]
+
+    # Margin options (margin_modules takes priority over margin)
+    if options[:margin]
+      args += ['-m', options[:margin].to_s]
+    elsif options[:margin_modules]
+      args += ['--margin-modules', options[:margin_modules].to_s]
+    end
+    args
+  end
+  private_class_method :cli_options
+end
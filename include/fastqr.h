@@ -23,6 +23,7 @@
 
 #include <string>
 #include <cstdint>
+#include <vector>
 
 namespace fastqr {
 
@@ -70,6 +71,63 @@ struct QROptions {
     // Margin (quiet zone) around QR code
     int margin = 0;                     // Margin in pixels (absolute, default: 0)
     int margin_modules = 4;             // Margin in modules (relative, default: 4 per ISO/IEC 18004)
+
+    // Mask pattern: 0-7 forces that pattern and skips the penalty search.
+    // MASK_AUTO scores all eight (ISO/IEC 18004), MASK_FAST scores all eight
+    // without the costly finder-like rule - valid, not always the best mask.
+    // Only the built-in encoder honors this (ignored with libqrencode).
+    enum MaskMode { MASK_AUTO = -1, MASK_FAST = -2 };
+    int mask = MASK_AUTO;
+
+    // Segmentation: SEGMENT_OPTIMAL mixes numeric, alphanumeric, byte and
+    // Kanji modes for the shortest bit stream (often a smaller version).
+    // SEGMENT_COMPAT reproduces libqrencode's symbols module for module.
+    // Only the built-in encoder honors this (ignored with libqrencode).
+    enum Segmentation { SEGMENT_OPTIMAL, SEGMENT_COMPAT };
+    Segmentation segmentation = SEGMENT_OPTIMAL;
+
+    // Scaling when modules do not land on whole pixels (size minus margins
+    // not a multiple of the QR width): SCALE_NEAREST gives every pixel one
+    // module's color, so modules end up a pixel wider or narrower than
+    // their neighbours. SCALE_AREA box-filters: pixels on a module edge get
+    // the blend of the colors they cover, so every module has the same
+    // weight. Black/white output is then 8-bit gray either way.
+    enum Scaling { SCALE_NEAREST, SCALE_AREA };
+    Scaling scaling = SCALE_NEAREST;
+};
+
+/**
+ * Pixel format chosen by the renderer
+ */
+enum class RenderPath {
+    NONE,       // Failed before rendering
+    INDEXED,    // 1-bit black/white (fastest)
+    GRAYSCALE,  // 8-bit gray
+    RGB         // 24-bit color
+};
+
+/**
+ * Per-call instrumentation, filled in when a stats pointer is passed
+ */
+struct GenerateStats {
+    // Stage timings in nanoseconds
+    uint64_t encode_ns = 0;     // Text -> module matrix
+    uint64_t rasterize_ns = 0;  // Scaling, colors and logo
+    uint64_t compress_ns = 0;   // PNG encoding (libpng + zlib)
+    uint64_t write_ns = 0;      // Flushing and closing the output file (0 for buffers)
+
+    // Code path
+    RenderPath path = RenderPath::NONE;
+    bool logo = false;           // Logo composited
+    bool integer_scale = false;  // Image size is a whole multiple of the QR width
+    bool matrix_cached = false;  // Module matrix reused from the matrix cache (encode skipped)
+    bool output_cached = false;  // Image reused from the output cache (nothing rendered; version,
+                                 // width and integer_scale are 0 for images read back from disk)
+
+    int qr_version = 0;          // 1-40
+    int qr_width = 0;            // Modules per side
+    int image_size = 0;          // Pixels per side
+    size_t output_bytes = 0;     // Encoded image size
 };
 
 /**
@@ -78,9 +136,11 @@ struct QROptions {
  * @param data The data to encode (supports UTF-8)
  * @param output_path Path to save the generated QR code image
  * @param options QR code generation options
+ * @param stats If not NULL, receives stage timings and render details
  * @return true if successful, false otherwise
  */
-bool generate(const std::string& data, const std::string& output_path, const QROptions& options = QROptions());
+bool generate(const std::string& data, const std::string& output_path, const QROptions& options = QROptions(),
+              GenerateStats* stats = nullptr);
 
 /**
  * Generate QR code and return image data as buffer
@@ -93,6 +153,133 @@ bool generate(const std::string& data, const std::string& output_path, const QRO
  */
 int generate_to_buffer(const std::string& data, void* buffer, size_t buffer_size, const QROptions& options = QROptions());
 
+/**
+ * Generate QR code into a caller-supplied buffer, reporting the required size
+ *
+ * Reentrant: safe to call concurrently from any number of threads.
+ *
+ * @param data The data to encode (supports UTF-8)
+ * @param buffer Output buffer for image data (may be NULL when buffer_size is 0)
+ * @param buffer_size Size of the output buffer
+ * @param required_size If not NULL, receives the encoded image size (0 on error)
+ * @param options QR code generation options
+ * @param stats If not NULL, receives stage timings and render details
+ * @return Size of image data written to buffer, or -1 on error or if buffer is too small
+ */
+int generate_to_buffer(const std::string& data, void* buffer, size_t buffer_size, size_t* required_size,
+                       const QROptions& options = QROptions(), GenerateStats* stats = nullptr);
+
+/**
+ * Generate QR code into a growable buffer
+ *
+ * Reentrant: safe to call concurrently from any number of threads.
+ *
+ * @param data The data to encode (supports UTF-8)
+ * @param output Receives the image data (replaces any previous contents)
+ * @param options QR code generation options
+ * @param stats If not NULL, receives stage timings and render details
+ * @return true if successful, false otherwise
+ */
+bool generate_to_buffer(const std::string& data, std::vector<uint8_t>& output, const QROptions& options = QROptions(),
+                        GenerateStats* stats = nullptr);
+
+/**
+ * Result of batch generation
+ */
+struct BatchResult {
+    std::vector<uint8_t> success;  // Per-item status, same order as input (1 = ok, 0 = failed)
+    size_t success_count = 0;
+    size_t fail_count = 0;
+};
+
+/**
+ * Generate multiple QR codes in parallel
+ *
+ * Items are spread over a work-stealing pool of std::threads (no OpenMP
+ * required). Files are named 1.png, 2.png, ... like CLI batch mode.
+ *
+ * @param data_list Data to encode, one QR code per item
+ * @param output_dir Existing directory to save the QR code images in
+ * @param options QR code generation options (applied to all items)
+ * @param threads Number of worker threads (0 = all cores)
+ * @param stats If not NULL, resized to data_list.size() and filled per item
+ * @return Per-item status and success/failure counts
+ */
+BatchResult generate_batch(const std::vector<std::string>& data_list, const std::string& output_dir,
+                           const QROptions& options = QROptions(), int threads = 0,
+                           std::vector<GenerateStats>* stats = nullptr);
+
+/**
+ * Counters and limits of a cache
+ */
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;      // Entries currently held
+    size_t bytes = 0;        // Bytes currently held (keys plus values)
+    size_t max_entries = 0;  // 0 = nothing kept in memory
+    size_t max_bytes = 0;    // 0 = no byte limit
+};
+
+/**
+ * Enable, resize or disable the module matrix cache
+ *
+ * A process-wide LRU cache of encoded module matrices, keyed on the data,
+ * ec_level, mask and segmentation. A repeated payload skips the encode
+ * stage and goes straight to rasterization, whatever its size, colors or
+ * logo. Disabled by default. Entries are spread over 16 independently
+ * locked shards, with the limits counted across all of them (the least
+ * recently used entry overall is evicted first); safe to call while other
+ * threads generate.
+ *
+ * @param max_entries Most matrices kept (0 disables the cache and frees it)
+ * @param max_bytes Most bytes kept, payloads plus matrices (0 = no byte limit)
+ */
+void set_matrix_cache(size_t max_entries, size_t max_bytes = 0);
+
+/**
+ * Hit/miss counters and occupancy of the module matrix cache
+ */
+CacheStats matrix_cache_stats();
+
+/**
+ * Drop every cached matrix and reset the counters (limits are kept)
+ */
+void clear_matrix_cache();
+
+/**
+ * Enable, resize or disable the rendered-output cache
+ *
+ * Identical data and options give byte-identical images, so the PNG of a
+ * repeated (data, QROptions) pair is reused instead of rendered again. The
+ * key covers the data, every option field, the logo file's size and
+ * modification time, and the library version. Images are kept in a sharded
+ * in-memory LRU (as in the matrix cache) and, if `directory` is given, as
+ * <hash>.qrc entry files there that outlive the process. Each entry holds
+ * digests of its key and PNG, checked on every read; a damaged or replaced
+ * entry counts as a miss. Outputs are always copies, never links to an
+ * entry. Disabled by default.
+ *
+ * @param max_entries Most images kept in memory (0 = none)
+ * @param max_bytes Most bytes kept in memory (0 = no byte limit)
+ * @param directory On-disk cache directory, created if missing ("" = memory only)
+ * @return false if the directory cannot be created (the cache is then off)
+ */
+bool set_output_cache(size_t max_entries, size_t max_bytes = 0, const std::string& directory = "");
+
+/**
+ * Hit/miss counters and memory occupancy of the output cache (hits include
+ * images read back from the directory)
+ */
+CacheStats output_cache_stats();
+
+/**
+ * Drop every image cached in memory and reset the counters (limits and the
+ * files in the directory are kept)
+ */
+void clear_output_cache();
+
 /**
  * Get library version
  *
@@ -138,6 +325,39 @@ typedef struct {
  */
 int fastqr_generate(const char* data, const char* output_path, const QROptions* options);
 
+/**
+ * Generate QR code into a caller-supplied buffer (C API, thread-safe)
+ *
+ * @param data Data to encode (UTF-8 string)
+ * @param buffer Output buffer for image data (may be NULL when buffer_size is 0)
+ * @param buffer_size Size of the output buffer
+ * @param required_size If not NULL, receives the encoded image size (0 on error)
+ * @param options Pointer to QROptions struct (can be NULL for defaults)
+ * @return Number of bytes written, or -1 on error or if buffer is too small
+ */
+int fastqr_generate_to_buffer(const char* data, unsigned char* buffer, size_t buffer_size,
+                              size_t* required_size, const QROptions* options);
+
+/**
+ * Generate QR code into a newly allocated buffer (C API, thread-safe)
+ *
+ * Intended for FFI callers that cannot size a buffer up front.
+ * Release the result with fastqr_free_buffer().
+ *
+ * @param data Data to encode (UTF-8 string)
+ * @param options Pointer to QROptions struct (can be NULL for defaults)
+ * @param size Receives the image data size (0 on error)
+ * @return Image data, or NULL on error
+ */
+unsigned char* fastqr_generate_buffer(const char* data, const QROptions* options, size_t* size);
+
+/**
+ * Free a buffer returned by fastqr_generate_buffer (C API)
+ *
+ * @param buffer Buffer to free (NULL is ignored)
+ */
+void fastqr_free_buffer(unsigned char* buffer);
+
 /**
  * Get library version (C API)
  *
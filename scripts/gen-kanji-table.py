@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# Generate src/kanji_table.h: Unicode -> QR Kanji mode values for every
+# double-byte Shift JIS (JIS X 0208) character the Kanji mode can hold.
+#
+# Usage: scripts/gen-kanji-table.py > src/kanji_table.h
+
+HEADER = """/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+// Generated by scripts/gen-kanji-table.py - do not edit.
+//
+// Characters QR Kanji mode can encode (Shift JIS 0x8140-0x9FFC and
+// 0xE040-0xEBBF), sorted by code point, with their 13-bit Kanji values.
+// KANJI_PAGES[hi]..KANJI_PAGES[hi + 1] is the slice of code points
+// 0xhi00-0xhiFF, so lookups only search within one page.
+
+#ifndef FASTQR_KANJI_TABLE_H
+#define FASTQR_KANJI_TABLE_H
+
+#include <cstdint>
+
+namespace fastqr {
+namespace qr {
+"""
+
+FOOTER = """
+} // namespace qr
+} // namespace fastqr
+
+#endif // FASTQR_KANJI_TABLE_H"""
+
+
+def kanji_value(sjis):
+    base = sjis - 0x8140 if sjis <= 0x9FFC else sjis - 0xC140
+    return (base >> 8) * 0xC0 + (base & 0xFF)
+
+
+def build():
+    table = {}
+    for hi in list(range(0x81, 0xA0)) + list(range(0xE0, 0xEC)):
+        for lo in range(0x40, 0xFD):
+            sjis = (hi << 8) | lo
+            if lo == 0x7F or sjis < 0x8140 or sjis > 0xEBBF:
+                continue
+            try:
+                ch = bytes([hi, lo]).decode("shift_jis")
+            except UnicodeDecodeError:
+                continue
+            if len(ch) != 1 or ord(ch) < 0x80:
+                continue
+            table.setdefault(ord(ch), kanji_value(sjis))
+    return sorted(table.items())
+
+
+def array(name, values, size="KANJI_COUNT"):
+    lines = ["const uint16_t %s[%s] = {" % (name, size)]
+    for i in range(0, len(values), 12):
+        lines.append("    " + " ".join("0x%04X," % v for v in values[i:i + 12]))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    entries = build()
+    print(HEADER)
+    print("const int KANJI_COUNT = %d;\n" % len(entries))
+    print(array("KANJI_CODEPOINTS", [cp for cp, _ in entries]))
+    print()
+    print(array("KANJI_VALUES", [v for _, v in entries]))
+    print()
+    pages = [sum(1 for cp, _ in entries if cp >> 8 < hi) for hi in range(257)]
+    print(array("KANJI_PAGES", pages, "257"))
+    print(FOOTER)
+
+
+if __name__ == "__main__":
+    main()
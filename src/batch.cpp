@@ -0,0 +1,154 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#include "fastqr.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <system_error>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace fastqr {
+
+// Contiguous range of item indices owned by one worker.
+// The owner pops from the front, idle workers steal the back half.
+struct WorkRange {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// Take the next item from our own range
+static bool pop_front(WorkRange& range, size_t& index) {
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin >= range.end) return false;
+    index = range.begin++;
+    return true;
+}
+
+// Move the back half of a victim's range into ours
+static bool steal(WorkRange& victim, WorkRange& self) {
+    size_t begin, end;
+    {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        size_t remaining = victim.end - victim.begin;
+        if (victim.begin >= victim.end) return false;
+        end = victim.end;
+        begin = victim.end - (remaining + 1) / 2;
+        victim.end = begin;
+    }
+
+    std::lock_guard<std::mutex> lock(self.mutex);
+    self.begin = begin;
+    self.end = end;
+    return true;
+}
+
+static int resolve_thread_count(int threads, size_t item_count) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) threads = 1;
+    }
+    return static_cast<int>(std::min<size_t>(threads, item_count));
+}
+
+BatchResult generate_batch(const std::vector<std::string>& data_list, const std::string& output_dir,
+                           const QROptions& options, int threads, std::vector<GenerateStats>* stats) {
+    BatchResult result;
+    result.success.assign(data_list.size(), 0);
+    if (stats) {
+        stats->assign(data_list.size(), GenerateStats());
+    }
+    if (data_list.empty()) {
+        return result;
+    }
+
+    std::string prefix = output_dir;
+    if (!prefix.empty() && prefix.back() != '/') {
+        prefix += '/';
+    }
+
+    int worker_count = resolve_thread_count(threads, data_list.size());
+
+    // Split items evenly, then let workers rebalance by stealing
+    std::unique_ptr<WorkRange[]> ranges(new WorkRange[worker_count]);
+    size_t per_worker = data_list.size() / worker_count;
+    size_t extra = data_list.size() % worker_count;
+    size_t next = 0;
+    for (int w = 0; w < worker_count; w++) {
+        ranges[w].begin = next;
+        next += per_worker + (static_cast<size_t>(w) < extra ? 1 : 0);
+        ranges[w].end = next;
+    }
+
+    // Items not yet taken by any worker. A failed steal pass does not mean
+    // the batch is done: a thief grows its own range, and a stolen half is
+    // in neither range while it moves. Workers only leave once this hits 0.
+    std::atomic<size_t> unclaimed(data_list.size());
+
+    auto worker = [&](int self) {
+        size_t index;
+        for (;;) {
+            while (pop_front(ranges[self], index)) {
+                unclaimed.fetch_sub(1, std::memory_order_relaxed);
+                // Output filename: 1.png, 2.png, ... (same as CLI batch mode)
+                std::string output_path = prefix + std::to_string(index + 1) + ".png";
+                GenerateStats* item_stats = stats ? &(*stats)[index] : nullptr;
+                result.success[index] = generate(data_list[index], output_path, options, item_stats) ? 1 : 0;
+            }
+
+            // Own range drained - look for work elsewhere
+            bool stolen = false;
+            for (int i = 1; i < worker_count && !stolen; i++) {
+                stolen = steal(ranges[(self + i) % worker_count], ranges[self]);
+            }
+            if (!stolen) {
+                if (unclaimed.load(std::memory_order_relaxed) == 0) return;
+                std::this_thread::yield();  // A steal is mid-flight, rescan
+            }
+        }
+    };
+
+    // If a thread cannot be started, carry on with the ones we have: the
+    // ranges of workers that never ran are stolen like any other.
+    std::vector<std::thread> pool;
+    pool.reserve(worker_count - 1);
+    for (int w = 1; w < worker_count; w++) {
+        try {
+            pool.emplace_back(worker, w);
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+    worker(0);  // Calling thread takes part too
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    for (uint8_t ok : result.success) {
+        if (ok) result.success_count++;
+        else result.fail_count++;
+    }
+    return result;
+}
+
+} // namespace fastqr
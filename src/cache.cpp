@@ -0,0 +1,399 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+// Process-wide caches behind generate() and friends
+
+#include "fastqr_internal.h"
+#include "lru_cache.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fastqr {
+namespace {
+
+// ---------------------------------------------------------------------------
+// Matrix cache
+
+detail::LruCache<detail::QRMatrix>& matrix_cache() {
+    static detail::LruCache<detail::QRMatrix> cache;
+    return cache;
+}
+
+// Everything the encode stage reads: the options it uses, then the data
+std::string matrix_key(const std::string& data, const QROptions& options) {
+    std::string key;
+    key.reserve(data.size() + 3);
+    key += static_cast<char>(options.ec_level);
+    key += static_cast<char>(options.mask);
+    key += static_cast<char>(options.segmentation);
+    key += data;
+    return key;
+}
+
+} // namespace
+
+std::shared_ptr<const detail::QRMatrix> detail::encode_qr_cached(const std::string& data,
+                                                                 const QROptions& options, bool* hit) {
+    if (hit) *hit = false;
+    detail::LruCache<QRMatrix>& cache = matrix_cache();
+    if (!cache.enabled()) {
+        auto matrix = std::make_shared<QRMatrix>();
+        if (!encode_qr(data, options, *matrix)) return nullptr;
+        return matrix;
+    }
+
+    std::string key = matrix_key(data, options);
+    std::shared_ptr<const QRMatrix> cached = cache.get(key);
+    if (cached) {
+        if (hit) *hit = true;
+        return cached;
+    }
+
+    auto matrix = std::make_shared<QRMatrix>();
+    if (!encode_qr(data, options, *matrix)) return nullptr;
+    cache.put(key, matrix, sizeof(QRMatrix) + matrix->modules.size());
+    return matrix;
+}
+
+void set_matrix_cache(size_t max_entries, size_t max_bytes) {
+    matrix_cache().set_limits(max_entries, max_bytes);
+}
+
+CacheStats matrix_cache_stats() {
+    return matrix_cache().stats();
+}
+
+void clear_matrix_cache() {
+    matrix_cache().clear();
+}
+
+// ---------------------------------------------------------------------------
+// Output cache
+
+namespace {
+
+// Encoded image with the render details of the call that produced it
+struct CachedOutput {
+    std::vector<uint8_t> png;
+    GenerateStats stats;
+};
+
+struct OutputCache {
+    detail::LruCache<CachedOutput> memory;
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> temp_serial{0};
+
+    std::mutex directory_mutex;
+    std::string directory;  // "" = memory only
+
+    std::string get_directory() {
+        std::lock_guard<std::mutex> lock(directory_mutex);
+        return directory;
+    }
+};
+
+OutputCache& output_cache() {
+    static OutputCache cache;
+    return cache;
+}
+
+void append_int(std::string& key, int64_t value) {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append_string(std::string& key, const std::string& value) {
+    append_int(key, static_cast<int64_t>(value.size()));
+    key += value;
+}
+
+// Every input of the render: library version, all options, the logo file's
+// identity and the data. False if the logo cannot be stat'ed.
+bool output_key(const std::string& data, const QROptions& options, std::string& key) {
+    key.clear();
+    key.reserve(data.size() + options.logo_path.size() + 160);
+    append_string(key, version());
+    append_int(key, options.size);
+    append_int(key, options.optimize_size);
+    append_int(key, options.foreground.r);
+    append_int(key, options.foreground.g);
+    append_int(key, options.foreground.b);
+    append_int(key, options.background.r);
+    append_int(key, options.background.g);
+    append_int(key, options.background.b);
+    append_int(key, static_cast<int>(options.ec_level));
+    append_string(key, options.logo_path);
+    if (!options.logo_path.empty()) {
+        struct stat st;
+        if (stat(options.logo_path.c_str(), &st) != 0) return false;
+        append_int(key, st.st_ino);
+        append_int(key, st.st_size);
+        append_int(key, st.st_mtime);
+    }
+    append_int(key, options.logo_size_percent);
+    append_string(key, options.format);
+    append_int(key, options.quality);
+    append_int(key, options.margin);
+    append_int(key, options.margin_modules);
+    append_int(key, options.mask);
+    append_int(key, options.segmentation);
+    append_int(key, options.scaling);
+    append_string(key, data);
+    return true;
+}
+
+uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t fmix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 128-bit MurmurHash3-style digest, as 32 hex digits (cache file names and
+// entry checks; not meant to resist deliberate collisions)
+std::string digest(const void* bytes, size_t size) {
+    const uint64_t C1 = 0x87C37B91114253D5ULL;
+    const uint64_t C2 = 0x4CF5AD432745937FULL;
+    const char* data = static_cast<const char*>(bytes);
+    uint64_t h1 = size;
+    uint64_t h2 = ~size;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, data + i, 8);
+        std::memcpy(&k2, data + i + 8, 8);
+        h1 ^= rotl64(k1 * C1, 31) * C2;
+        h1 = (rotl64(h1, 27) + h2) * 5 + 0x52DCE729;
+        h2 ^= rotl64(k2 * C2, 33) * C1;
+        h2 = (rotl64(h2, 31) + h1) * 5 + 0x38495AB5;
+    }
+    uint64_t tail[2] = {0, 0};
+    std::memcpy(tail, data + i, size - i);
+    h1 ^= rotl64(tail[0] * C1, 31) * C2;
+    h2 ^= rotl64(tail[1] * C2, 33) * C1;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    char hex[33];
+    std::snprintf(hex, sizeof(hex), "%016llx%016llx", static_cast<unsigned long long>(h1),
+                  static_cast<unsigned long long>(h2));
+    return hex;
+}
+
+// Cache entry file: a fixed header, then the PNG. The header repeats the
+// key's digest and a digest of the PNG, so an entry that was replaced,
+// truncated or overwritten reads as a miss rather than as someone else's
+// image.
+const char ENTRY_MAGIC[8] = {'F', 'Q', 'R', 'C', 'A', 'C', 'H', '1'};
+const size_t ENTRY_HEADER = sizeof(ENTRY_MAGIC) + 32 + 32;
+
+std::string entry_header(const std::string& key_hex, const std::vector<uint8_t>& png) {
+    return std::string(ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) + key_hex + digest(png.data(), png.size());
+}
+
+// The PNG of an entry file, if it is there and intact
+bool read_entry_file(const std::string& path, const std::string& key_hex, std::vector<uint8_t>& png) {
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    bool ok = fseek(fp, 0, SEEK_END) == 0;
+    long size = ok ? ftell(fp) : -1;
+    ok = size > static_cast<long>(ENTRY_HEADER + 33) && fseek(fp, 0, SEEK_SET) == 0;
+    char header[ENTRY_HEADER];
+    if (ok) {
+        png.resize(static_cast<size_t>(size) - ENTRY_HEADER);
+        ok = fread(header, 1, ENTRY_HEADER, fp) == ENTRY_HEADER &&
+             fread(png.data(), 1, png.size(), fp) == png.size();
+    }
+    fclose(fp);
+    return ok && std::memcmp(png.data(), SIGNATURE, 8) == 0 &&
+           std::string(header, ENTRY_HEADER) == entry_header(key_hex, png);
+}
+
+bool write_file(const std::string& path, const std::string& header, const std::vector<uint8_t>& png) {
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(header.data(), 1, header.size(), fp) == header.size() &&
+              fwrite(png.data(), 1, png.size(), fp) == png.size();
+    if (fclose(fp) != 0) ok = false;
+    return ok;
+}
+
+// Add an entry to the directory: written under a unique temporary name and
+// renamed into place, so readers never see a partial file
+bool store_entry_file(OutputCache& cache, const std::string& path, const std::string& key_hex,
+                      const std::vector<uint8_t>& png) {
+    std::string temp = path + ".tmp" + std::to_string(getpid()) + "." + std::to_string(cache.temp_serial++);
+    if (write_file(temp, entry_header(key_hex, png), png) && rename(temp.c_str(), path.c_str()) == 0) return true;
+    unlink(temp.c_str());
+    return false;
+}
+
+// Render details of an image read back from disk: what its header tells
+GenerateStats png_stats(const std::vector<uint8_t>& png, const QROptions& options) {
+    GenerateStats stats;
+    stats.image_size = (png[16] << 24) | (png[17] << 16) | (png[18] << 8) | png[19];
+    switch (png[25]) {  // IHDR color type
+        case 3: stats.path = RenderPath::INDEXED; break;
+        case 0: stats.path = RenderPath::GRAYSCALE; break;
+        default: stats.path = RenderPath::RGB; break;
+    }
+    stats.logo = !options.logo_path.empty();
+    return stats;
+}
+
+// Deliver a cached image: a copy of its bytes, never a link to the entry
+// file, since the caller may later rewrite its output in place
+bool deliver(const PngSink& sink, const std::vector<uint8_t>& png) {
+    if (!sink.filename) {
+        *sink.buffer = png;
+        return true;
+    }
+    return write_file(sink.filename, std::string(), png);
+}
+
+} // namespace
+
+bool detail::generate_png_cached(const std::string& data, const PngSink& sink, const QROptions& options,
+                                 GenerateStats* stats) {
+    OutputCache& cache = output_cache();
+    std::string key;
+    if (!cache.enabled.load(std::memory_order_relaxed) || !output_key(data, options, key)) {
+        return generate_png(data, sink, options, stats);
+    }
+
+    uint64_t start = stats ? now_ns() : 0;
+    std::string directory = cache.get_directory();
+    std::string key_hex = directory.empty() ? std::string() : digest(key.data(), key.size());
+    std::string file = directory.empty() ? std::string() : directory + "/" + key_hex + ".qrc";
+
+    std::shared_ptr<const CachedOutput> cached;
+    if (cache.memory.enabled()) {
+        cached = cache.memory.get(key);
+    }
+    if (!cached && !file.empty()) {
+        auto loaded = std::make_shared<CachedOutput>();
+        if (read_entry_file(file, key_hex, loaded->png)) {
+            loaded->stats = png_stats(loaded->png, options);
+            loaded->stats.output_bytes = loaded->png.size();
+            if (cache.memory.enabled()) {
+                cache.memory.put(key, loaded, sizeof(CachedOutput) + loaded->png.size());
+            }
+            cached = loaded;
+        }
+    }
+
+    if (cached) {
+        cache.hits++;
+        if (!deliver(sink, cached->png)) return false;
+        if (stats) {
+            // Render details of the original call; the time spent is all lookup and copying
+            GenerateStats original = cached->stats;
+            *stats = GenerateStats();
+            stats->path = original.path;
+            stats->logo = original.logo;
+            stats->integer_scale = original.integer_scale;
+            stats->qr_version = original.qr_version;
+            stats->qr_width = original.qr_width;
+            stats->image_size = original.image_size;
+            stats->output_bytes = cached->png.size();
+            stats->output_cached = true;
+            stats->write_ns = now_ns() - start;
+        }
+        return true;
+    }
+
+    // Miss: render to memory, keep it, then hand it to the sink
+    cache.misses++;
+    auto rendered = std::make_shared<CachedOutput>();
+    PngSink memory_sink;
+    memory_sink.buffer = &rendered->png;
+    if (!generate_png(data, memory_sink, options, &rendered->stats)) {
+        if (stats) *stats = rendered->stats;
+        return false;
+    }
+    if (stats) *stats = rendered->stats;
+
+    uint64_t written = stats ? now_ns() : 0;
+    if (!file.empty()) store_entry_file(cache, file, key_hex, rendered->png);
+    if (cache.memory.enabled()) {
+        cache.memory.put(key, rendered, sizeof(CachedOutput) + rendered->png.size());
+    }
+    if (!deliver(sink, rendered->png)) return false;
+    if (stats && sink.filename) {
+        stats->write_ns = now_ns() - written;
+    }
+    return true;
+}
+
+bool set_output_cache(size_t max_entries, size_t max_bytes, const std::string& directory) {
+    OutputCache& cache = output_cache();
+    std::string dir = directory;
+    while (dir.size() > 1 && dir.back() == '/') dir.pop_back();
+    bool ok = true;
+    if (!dir.empty()) {
+        struct stat st;
+        if (mkdir(dir.c_str(), 0755) != 0 && !(errno == EEXIST && stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode))) {
+            ok = false;
+            dir.clear();
+            max_entries = 0;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(cache.directory_mutex);
+        cache.directory = dir;
+    }
+    cache.memory.set_limits(max_entries, max_bytes);
+    cache.enabled.store(max_entries > 0 || !dir.empty(), std::memory_order_relaxed);
+    return ok;
+}
+
+CacheStats output_cache_stats() {
+    OutputCache& cache = output_cache();
+    CacheStats stats = cache.memory.stats();
+    stats.hits = cache.hits.load();
+    stats.misses = cache.misses.load();
+    return stats;
+}
+
+void clear_output_cache() {
+    OutputCache& cache = output_cache();
+    cache.memory.clear();
+    cache.hits = 0;
+    cache.misses = 0;
+}
+
+} // namespace fastqr
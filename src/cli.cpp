@@ -19,11 +19,13 @@
  */
 
 #include "fastqr.h"
+#include "serve.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
 #include <sys/stat.h>
 #include <errno.h>
 
@@ -34,7 +36,8 @@
 void print_usage(const char* program_name) {
     std::cout << "FastQR v" << fastqr::version() << " - Fast QR Code Generator\n\n";
     std::cout << "Usage: " << program_name << " [OPTIONS] <data> <output_file>\n";
-    std::cout << "       " << program_name << " [OPTIONS] -F <input.txt> <output_dir>\n\n";
+    std::cout << "       " << program_name << " [OPTIONS] -F <input.txt> <output_dir>\n";
+    std::cout << "       " << program_name << " [OPTIONS] --serve\n\n";
     std::cout << "Options:\n";
     std::cout << "  -s, --size SIZE         Output size in pixels (default: 300)\n";
     std::cout << "  -o, --optimize          Auto round-up size for best performance\n";
@@ -46,7 +49,16 @@ void print_usage(const char* program_name) {
     std::cout << "  -q, --quality N         Image quality 1-100 (default: 95)\n";
     std::cout << "  -m, --margin N          Margin (quiet zone) in pixels (default: 0)\n";
     std::cout << "  --margin-modules N      Margin in modules (default: 4, ISO standard)\n";
+    std::cout << "  --mask 0-7|fast|auto    Force a mask pattern, or pick it with a cheaper score (default: auto)\n";
+    std::cout << "  --segments optimal|compat  Shortest mixed-mode encoding, or libqrencode's (default: optimal)\n";
+    std::cout << "  --scaling nearest|area  Fractional module sizes: whole pixels, or blended edges (default: nearest)\n";
     std::cout << "  -F, --file PATH         Batch mode: process text file (one QR per line)\n";
+    std::cout << "  -t, --threads N         Max worker threads for batch mode (default: all cores)\n";
+    std::cout << "  --matrix-cache N[,MB]   Reuse the encoded matrix of repeated data (N entries, MB limit)\n";
+    std::cout << "  --output-cache N[,MB]   Reuse the image of repeated data and options (N in memory, MB limit)\n";
+    std::cout << "  --output-cache-dir DIR  Also keep cached images in DIR across runs\n";
+    std::cout << "  --stats                 Print per-stage timings and render path summary\n";
+    std::cout << "  --serve                 Stay resident: JSON-lines requests on stdin, PNG on stdout\n";
     std::cout << "  -h, --help              Show this help\n";
     std::cout << "  -v, --version           Show version\n\n";
     std::cout << "Examples:\n";
@@ -58,6 +70,13 @@ void print_usage(const char* program_name) {
     std::cout << "  " << program_name << " -s 400 -m 10 \"With margin pixels\" margin.png\n";
     std::cout << "  " << program_name << " -s 400 --margin-modules 4 \"ISO standard\" iso.png\n";
     std::cout << "  " << program_name << " -F batch.txt output_dir/ -s 500 -o\n";
+    std::cout << "  " << program_name << " -F batch.txt output_dir/ -t 4\n";
+    std::cout << "  " << program_name << " -F coupons.txt output_dir/ --mask fast\n";
+    std::cout << "  " << program_name << " -F batch.txt output_dir/ --stats\n";
+    std::cout << "  " << program_name << " -s 250 --scaling area \"Thumbnail\" thumb.png\n";
+    std::cout << "  " << program_name << " -F products.txt output_dir/ --matrix-cache 10000 --stats\n";
+    std::cout << "  " << program_name << " -F reprint.txt output_dir/ --output-cache-dir ~/.cache/fastqr\n";
+    std::cout << "  echo '{\"data\":\"Hello\",\"output\":\"qr.png\"}' | " << program_name << " --serve -s 500\n";
 }
 
 bool parse_color(const char* str, fastqr::QROptions::Color& color) {
@@ -74,6 +93,57 @@ bool parse_color(const char* str, fastqr::QROptions::Color& color) {
     return true;
 }
 
+bool parse_mask(const char* str, int& mask) {
+    if (strcmp(str, "auto") == 0) {
+        mask = fastqr::QROptions::MASK_AUTO;
+        return true;
+    }
+    if (strcmp(str, "fast") == 0) {
+        mask = fastqr::QROptions::MASK_FAST;
+        return true;
+    }
+    if (str[0] < '0' || str[0] > '7' || str[1] != '\0') {
+        return false;
+    }
+    mask = str[0] - '0';
+    return true;
+}
+
+bool parse_segmentation(const char* str, fastqr::QROptions::Segmentation& segmentation) {
+    if (strcmp(str, "optimal") == 0) {
+        segmentation = fastqr::QROptions::SEGMENT_OPTIMAL;
+        return true;
+    }
+    if (strcmp(str, "compat") == 0) {
+        segmentation = fastqr::QROptions::SEGMENT_COMPAT;
+        return true;
+    }
+    return false;
+}
+
+bool parse_scaling(const char* str, fastqr::QROptions::Scaling& scaling) {
+    if (strcmp(str, "nearest") == 0) {
+        scaling = fastqr::QROptions::SCALE_NEAREST;
+        return true;
+    }
+    if (strcmp(str, "area") == 0) {
+        scaling = fastqr::QROptions::SCALE_AREA;
+        return true;
+    }
+    return false;
+}
+
+bool parse_cache_limits(const char* str, size_t& max_entries, size_t& max_bytes) {
+    unsigned long entries = 0, mb = 0;
+    int n = sscanf(str, "%lu,%lu", &entries, &mb);
+    if (n < 1 || entries == 0) {
+        return false;
+    }
+    max_entries = entries;
+    max_bytes = n == 2 ? mb << 20 : 0;
+    return true;
+}
+
 bool parse_size(const char* str, int& size) {
     if (sscanf(str, "%d", &size) != 1) {
         return false;
@@ -136,9 +206,91 @@ bool read_batch_file(const std::string& filename, std::vector<std::string>& line
     return true;
 }
 
+// Aggregate of per-item GenerateStats for --stats
+struct StatsSummary {
+    size_t count = 0;
+    uint64_t encode_ns = 0;
+    uint64_t rasterize_ns = 0;
+    uint64_t compress_ns = 0;
+    uint64_t write_ns = 0;
+    uint64_t output_bytes = 0;
+    size_t indexed = 0;
+    size_t grayscale = 0;
+    size_t rgb = 0;
+    size_t logo = 0;
+    size_t integer_scale = 0;
+    size_t matrix_cached = 0;
+    size_t output_cached = 0;
+    int min_version = 0;
+    int max_version = 0;
+
+    void add(const fastqr::GenerateStats& stats) {
+        if (stats.path == fastqr::RenderPath::NONE) return;  // Failed item
+        if (stats.qr_version > 0) {  // Unknown for images read back from the cache directory
+            if (min_version == 0 || stats.qr_version < min_version) min_version = stats.qr_version;
+            if (stats.qr_version > max_version) max_version = stats.qr_version;
+        }
+        count++;
+        encode_ns += stats.encode_ns;
+        rasterize_ns += stats.rasterize_ns;
+        compress_ns += stats.compress_ns;
+        write_ns += stats.write_ns;
+        output_bytes += stats.output_bytes;
+        if (stats.path == fastqr::RenderPath::INDEXED) indexed++;
+        else if (stats.path == fastqr::RenderPath::GRAYSCALE) grayscale++;
+        else rgb++;
+        if (stats.logo) logo++;
+        if (stats.integer_scale) integer_scale++;
+        if (stats.matrix_cached) matrix_cached++;
+        if (stats.output_cached) output_cached++;
+    }
+};
+
+void print_stats(const StatsSummary& sum) {
+    if (sum.count == 0) {
+        std::cout << "Stats: no QR codes generated\n";
+        return;
+    }
+
+    uint64_t total_ns = sum.encode_ns + sum.rasterize_ns + sum.compress_ns + sum.write_ns;
+    auto stage = [&](const char* name, uint64_t ns) {
+        char line[128];
+        std::snprintf(line, sizeof(line), "  %-10s %10.3f ms total %10.1f us avg %6.1f%%\n", name, ns / 1e6,
+                      ns / 1e3 / sum.count, total_ns ? 100.0 * ns / total_ns : 0.0);
+        std::cout << line;
+    };
+
+    std::cout << "Stats (" << sum.count << " QR codes, stage times summed over all threads):\n";
+    stage("encode", sum.encode_ns);
+    stage("rasterize", sum.rasterize_ns);
+    stage("compress", sum.compress_ns);
+    stage("write", sum.write_ns);
+    std::cout << "  output     " << sum.output_bytes << " bytes total, " << sum.output_bytes / sum.count
+              << " avg\n";
+    if (sum.max_version > 0) {
+        std::cout << "  version    " << sum.min_version;
+        if (sum.max_version != sum.min_version) std::cout << "-" << sum.max_version;
+        std::cout << "\n";
+    }
+    std::cout << "  path       indexed " << sum.indexed << ", grayscale " << sum.grayscale << ", rgb " << sum.rgb
+              << " (logo " << sum.logo << ", integer scale " << sum.integer_scale << ")\n";
+
+    fastqr::CacheStats cache = fastqr::matrix_cache_stats();
+    if (cache.max_entries > 0) {
+        std::cout << "  matrix     " << sum.matrix_cached << " reused from cache (" << cache.entries << " entries, "
+                  << cache.bytes << " bytes, " << cache.evictions << " evicted)\n";
+    }
+
+    cache = fastqr::output_cache_stats();
+    if (cache.hits + cache.misses > 0) {
+        std::cout << "  image      " << sum.output_cached << " reused from cache (" << cache.entries
+                  << " in memory, " << cache.bytes << " bytes, " << cache.evictions << " evicted)\n";
+    }
+}
+
 // Process batch with parallel processing
 bool process_batch(const std::string& input_file, const std::string& output_dir,
-                   const fastqr::QROptions& options) {
+                   const fastqr::QROptions& options, int threads, bool show_stats) {
     // Read input file
     std::vector<std::string> lines;
     if (!read_batch_file(input_file, lines)) {
@@ -155,6 +307,16 @@ bool process_batch(const std::string& input_file, const std::string& output_dir,
 
     int success_count = 0;
     int fail_count = 0;
+    std::vector<fastqr::GenerateStats> stats;
+
+#ifdef _OPENMP
+    if (show_stats) {
+        stats.resize(lines.size());
+    }
+
+    if (threads > 0) {
+        omp_set_num_threads(threads);
+    }
 
     // Parallel processing with OpenMP
     #pragma omp parallel for schedule(dynamic, 10) reduction(+:success_count,fail_count)
@@ -167,7 +329,8 @@ bool process_batch(const std::string& input_file, const std::string& output_dir,
         output_path += std::to_string(i + 1) + ".png";
 
         // Generate QR code (reusing single-QR generation - no overhead!)
-        if (fastqr::generate(lines[i], output_path, options)) {
+        fastqr::GenerateStats* item_stats = show_stats ? &stats[i] : nullptr;
+        if (fastqr::generate(lines[i], output_path, options, item_stats)) {
             success_count++;
         } else {
             fail_count++;
@@ -177,9 +340,29 @@ bool process_batch(const std::string& input_file, const std::string& output_dir,
             }
         }
     }
+#else
+    // No OpenMP (e.g. fully static musl builds) - use the library's thread pool
+    fastqr::BatchResult result = fastqr::generate_batch(lines, output_dir, options, threads,
+                                                        show_stats ? &stats : nullptr);
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!result.success[i]) {
+            std::cerr << "Error: Failed to generate QR " << (i + 1) << std::endl;
+        }
+    }
+    success_count = static_cast<int>(result.success_count);
+    fail_count = static_cast<int>(result.fail_count);
+#endif
 
     std::cout << "Done: " << success_count << " success, " << fail_count << " failed" << std::endl;
 
+    if (show_stats) {
+        StatsSummary summary;
+        for (const auto& item : stats) {
+            summary.add(item);
+        }
+        print_stats(summary);
+    }
+
     return fail_count == 0;
 }
 
@@ -193,6 +376,11 @@ int main(int argc, char* argv[]) {
     std::string data;
     std::string output_path;
     std::string batch_file;  // For batch mode
+    int threads = 0;         // 0 = use all cores
+    bool serve = false;      // Persistent worker mode
+    bool show_stats = false; // --stats
+    size_t output_cache_entries = 0, output_cache_bytes = 0;
+    std::string output_cache_dir;
 
     // Parse arguments
     for (int i = 1; i < argc; i++) {
@@ -294,12 +482,79 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Margin modules must be between 0 and 50\n";
                 return 1;
             }
+        } else if (arg == "--mask") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            if (!parse_mask(argv[i], options.mask)) {
+                std::cerr << "Error: Mask must be 0-7, fast or auto\n";
+                return 1;
+            }
+        } else if (arg == "--segments") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            if (!parse_segmentation(argv[i], options.segmentation)) {
+                std::cerr << "Error: Segments must be optimal or compat\n";
+                return 1;
+            }
+        } else if (arg == "--scaling") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            if (!parse_scaling(argv[i], options.scaling)) {
+                std::cerr << "Error: Scaling must be nearest or area\n";
+                return 1;
+            }
         } else if (arg == "-F" || arg == "--file") {
             if (++i >= argc) {
                 std::cerr << "Error: " << arg << " requires an argument\n";
                 return 1;
             }
             batch_file = argv[i];
+        } else if (arg == "-t" || arg == "--threads") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            threads = atoi(argv[i]);
+            if (threads < 1 || threads > 1024) {
+                std::cerr << "Error: Threads must be between 1 and 1024\n";
+                return 1;
+            }
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg == "--matrix-cache") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            size_t max_entries, max_bytes;
+            if (!parse_cache_limits(argv[i], max_entries, max_bytes)) {
+                std::cerr << "Error: Invalid matrix cache size. Use ENTRIES or ENTRIES,MB (e.g., 10000,64)\n";
+                return 1;
+            }
+            fastqr::set_matrix_cache(max_entries, max_bytes);
+        } else if (arg == "--output-cache") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            if (!parse_cache_limits(argv[i], output_cache_entries, output_cache_bytes)) {
+                std::cerr << "Error: Invalid output cache size. Use ENTRIES or ENTRIES,MB (e.g., 1000,256)\n";
+                return 1;
+            }
+        } else if (arg == "--output-cache-dir") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            output_cache_dir = argv[i];
+        } else if (arg == "--stats") {
+            show_stats = true;
         } else if (arg[0] == '-') {
             std::cerr << "Error: Unknown option: " << arg << std::endl;
             return 1;
@@ -316,6 +571,21 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if ((output_cache_entries > 0 || !output_cache_dir.empty()) &&
+        !fastqr::set_output_cache(output_cache_entries, output_cache_bytes, output_cache_dir)) {
+        std::cerr << "Error: Cannot create directory: " << output_cache_dir << std::endl;
+        return 1;
+    }
+
+    // Serve mode: options on the command line become per-request defaults
+    if (serve) {
+        if (!batch_file.empty() || !data.empty()) {
+            std::cerr << "Error: --serve takes no data, output or batch file arguments\n";
+            return 1;
+        }
+        return run_serve_mode(options, stdin, stdout);
+    }
+
     // Batch mode vs single mode
     if (!batch_file.empty()) {
         // Batch mode: --file <input.txt> <output_dir>
@@ -328,7 +598,7 @@ int main(int argc, char* argv[]) {
         // In batch mode, first non-option arg is output_dir
         std::string output_dir = data;
 
-        if (!process_batch(batch_file, output_dir, options)) {
+        if (!process_batch(batch_file, output_dir, options, threads, show_stats)) {
             return 1;
         }
     } else {
@@ -340,10 +610,17 @@ int main(int argc, char* argv[]) {
         }
 
         // Generate single QR code (no overhead - same performance as before!)
-        if (!fastqr::generate(data, output_path, options)) {
+        fastqr::GenerateStats stats;
+        if (!fastqr::generate(data, output_path, options, show_stats ? &stats : nullptr)) {
             std::cerr << "Error: Failed to generate QR code\n";
             return 1;
         }
+
+        if (show_stats) {
+            StatsSummary summary;
+            summary.add(stats);
+            print_stats(summary);
+        }
     }
 
     return 0;
@@ -19,22 +19,30 @@
  */
 
 #include "fastqr.h"
+#include "fastqr_internal.h"
+#include "raster.h"
+#ifdef FASTQR_WITH_LIBQRENCODE
+#include "text_class.h"
 #include <qrencode.h>
+#endif
 #include <png.h>
 #include <zlib.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include <cstring>
+#include <chrono>
 #include <memory>
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 
 #define FASTQR_VERSION "1.0.28"
 
 namespace fastqr {
 
+#ifdef FASTQR_WITH_LIBQRENCODE
 // RAII wrapper for QRcode
 struct QRCodeDeleter {
     void operator()(QRcode* qr) const {
@@ -43,7 +51,6 @@ struct QRCodeDeleter {
 };
 using QRCodePtr = std::unique_ptr<QRcode, QRCodeDeleter>;
 
-// Detect text encoding and return appropriate encoding mode
 static QRecLevel to_qr_level(ErrorCorrectionLevel level) {
     switch (level) {
         case ErrorCorrectionLevel::LOW: return QR_ECLEVEL_L;
@@ -54,67 +61,108 @@ static QRecLevel to_qr_level(ErrorCorrectionLevel level) {
     }
 }
 
-// Detect if string contains only ASCII
-static bool is_ascii(const std::string& str) {
-    for (unsigned char c : str) {
-        if (c > 127) return false;
-    }
-    return true;
-}
-
 // Generate QR code using libqrencode with proper UTF-8 support
-static QRCodePtr generate_qr_code(const std::string& data, ErrorCorrectionLevel ec_level) {
-    QRecLevel level = to_qr_level(ec_level);
+// (libqrencode has no public API to force a mask, so `mask` and
+// `segmentation` are ignored)
+bool detail::encode_qr(const std::string& data, const QROptions& options, QRMatrix& matrix) {
+    QRecLevel level = to_qr_level(options.ec_level);
 
     // Use appropriate encoding based on content
-    QRcode* qr = nullptr;
-    if (is_ascii(data)) {
+    QRCodePtr qr;
+    if (qr::classify_text(data.data(), data.size()).ascii) {
         // ASCII data - use standard encoding
-        qr = QRcode_encodeString(data.c_str(), 0, level, QR_MODE_8, 1);
+        qr.reset(QRcode_encodeString(data.c_str(), 0, level, QR_MODE_8, 1));
     } else {
         // UTF-8 data - encode as 8-bit data
-        qr = QRcode_encodeData(data.length(),
-                               reinterpret_cast<const unsigned char*>(data.c_str()),
-                               0, level);
+        qr.reset(QRcode_encodeData(data.length(),
+                                   reinterpret_cast<const unsigned char*>(data.c_str()),
+                                   0, level));
     }
 
     if (!qr) {
         std::cerr << "Failed to generate QR code" << std::endl;
-        return nullptr;
+        return false;
+    }
+
+    matrix.version = qr->version;
+    matrix.width = qr->width;
+    matrix.mask = -1;
+    matrix.modules.resize(static_cast<size_t>(qr->width) * qr->width);
+    for (size_t i = 0; i < matrix.modules.size(); i++) {
+        matrix.modules[i] = qr->data[i] & 1;
+    }
+    return true;
+}
+#else
+// Generate QR code with the built-in encoder (see qr_encoder.h)
+bool detail::encode_qr(const std::string& data, const QROptions& options, QRMatrix& matrix) {
+    if (!qr::encode(data, options, matrix)) {
+        std::cerr << "Failed to generate QR code" << std::endl;
+        return false;
     }
+    return true;
+}
+#endif
 
-    return QRCodePtr(qr);
+// libpng write callback - append encoded bytes to the sink buffer
+static void png_buffer_write(png_structp png, png_bytep data, png_size_t length) {
+    auto* buffer = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+    buffer->insert(buffer->end(), data, data + length);
 }
 
-// Write indexed PNG (1-bit, black and white) - fastest method
-static bool write_indexed_png(const char* filename, const std::vector<unsigned char>& data,
-                               int width, int height) {
-    FILE* fp = fopen(filename, "wb");
-    if (!fp) return false;
+static void png_buffer_flush(png_structp) {
+    // Nothing to flush for memory output
+}
 
-    // Large buffer for faster I/O
-    setvbuf(fp, nullptr, _IOFBF, 65536);
+uint64_t detail::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
+// Open the file behind a file sink (returns nullptr for memory sinks)
+static FILE* open_sink(const PngSink& sink) {
+    if (!sink.filename) return nullptr;
+    FILE* fp = fopen(sink.filename, "wb");
+    if (fp) {
+        // Large buffer for faster I/O
+        setvbuf(fp, nullptr, _IOFBF, 65536);
+    }
+    return fp;
+}
+
+static bool close_sink(FILE* fp) {
+    return !fp || fclose(fp) == 0;
+}
+
+// Route libpng output to the sink
+static void attach_sink(png_structp png, const PngSink& sink, FILE* fp) {
+    if (fp) {
+        png_init_io(png, fp);
+    } else {
+        png_set_write_fn(png, sink.buffer, png_buffer_write, png_buffer_flush);
+    }
+}
+
+// Write indexed PNG (1-bit, black and white) - fastest method
+static bool write_indexed_png(const PngSink& sink, FILE* fp, const std::vector<unsigned char>& data,
+                              int width, int height) {
     png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if (!png) {
-        fclose(fp);
         return false;
     }
 
     png_infop info = png_create_info_struct(png);
     if (!info) {
         png_destroy_write_struct(&png, nullptr);
-        fclose(fp);
         return false;
     }
 
     if (setjmp(png_jmpbuf(png))) {
         png_destroy_write_struct(&png, &info);
-        fclose(fp);
         return false;
     }
 
-    png_init_io(png, fp);
+    attach_sink(png, sink, fp);
 
     // Set PNG parameters for 1-bit indexed (palette)
     png_set_IHDR(png, info, width, height, 1, PNG_COLOR_TYPE_PALETTE,
@@ -144,36 +192,29 @@ static bool write_indexed_png(const char* filename, const std::vector<unsigned c
     png_write_end(png, nullptr);
 
     png_destroy_write_struct(&png, &info);
-    fclose(fp);
     return true;
 }
 
 // Write grayscale PNG (8-bit)
-static bool write_grayscale_png(const char* filename, const std::vector<unsigned char>& data,
+static bool write_grayscale_png(const PngSink& sink, FILE* fp, const std::vector<unsigned char>& data,
                                 int width, int height) {
-    FILE* fp = fopen(filename, "wb");
-    if (!fp) return false;
-
     png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if (!png) {
-        fclose(fp);
         return false;
     }
 
     png_infop info = png_create_info_struct(png);
     if (!info) {
         png_destroy_write_struct(&png, nullptr);
-        fclose(fp);
         return false;
     }
 
     if (setjmp(png_jmpbuf(png))) {
         png_destroy_write_struct(&png, &info);
-        fclose(fp);
         return false;
     }
 
-    png_init_io(png, fp);
+    attach_sink(png, sink, fp);
     png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_GRAY,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
@@ -191,36 +232,29 @@ static bool write_grayscale_png(const char* filename, const std::vector<unsigned
     png_write_end(png, nullptr);
 
     png_destroy_write_struct(&png, &info);
-    fclose(fp);
     return true;
 }
 
 // Write RGB PNG
-static bool write_rgb_png(const char* filename, const std::vector<unsigned char>& data,
+static bool write_rgb_png(const PngSink& sink, FILE* fp, const std::vector<unsigned char>& data,
                           int width, int height) {
-    FILE* fp = fopen(filename, "wb");
-    if (!fp) return false;
-
     png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if (!png) {
-        fclose(fp);
         return false;
     }
 
     png_infop info = png_create_info_struct(png);
     if (!info) {
         png_destroy_write_struct(&png, nullptr);
-        fclose(fp);
         return false;
     }
 
     if (setjmp(png_jmpbuf(png))) {
         png_destroy_write_struct(&png, &info);
-        fclose(fp);
         return false;
     }
 
-    png_init_io(png, fp);
+    attach_sink(png, sink, fp);
     png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
@@ -238,7 +272,6 @@ static bool write_rgb_png(const char* filename, const std::vector<unsigned char>
     png_write_end(png, nullptr);
 
     png_destroy_write_struct(&png, &info);
-    fclose(fp);
     return true;
 }
 
@@ -348,15 +381,18 @@ static void add_logo_to_image(std::vector<unsigned char>& qr_img, int qr_size, i
     }
 }
 
-bool generate(const std::string& data, const std::string& output_path, const QROptions& options) {
-    // Generate QR code
-    auto qr = generate_qr_code(data, options.ec_level);
-    if (!qr) {
-        return false;
-    }
+// Hand a finished pixel buffer over to the raster image
+static bool finish_image(detail::RasterImage& image, detail::PixelFormat format, int size,
+                         std::vector<unsigned char>& pixels) {
+    image.format = format;
+    image.width = size;
+    image.height = size;
+    image.pixels.swap(pixels);
+    return true;
+}
 
-    int qr_size = qr->width;
-    unsigned char* qr_data = qr->data;
+bool detail::rasterize(const QRMatrix& qr, const QROptions& options, RasterImage& image) {
+    int qr_size = qr.width;
 
     // Determine final output size
     int final_size = options.size;
@@ -402,316 +438,168 @@ bool generate(const std::string& data, const std::string& output_path, const QRO
         std::cerr << "Error: Size too small with margin for QR code" << std::endl;
         return false;
     }
+    image.integer_scale = inner_size % qr_size == 0;
 
     // Check if using default black/white colors
     bool is_bw = (options.foreground.r == 0 && options.foreground.g == 0 && options.foreground.b == 0 &&
                   options.background.r == 255 && options.background.g == 255 && options.background.b == 255);
+    bool has_logo = !options.logo_path.empty();
 
-    // Check if we can use indexed PNG (only if no logo)
-    bool can_use_indexed = is_bw && options.logo_path.empty();
-
-    if (can_use_indexed) {
-        // FASTEST PATH: 1-bit indexed PNG (like qrencode)
-        // Pack 8 pixels into 1 byte
-        int scale = inner_size / qr_size;
-
-        if (scale * qr_size == inner_size && margin == 0) {
-            // Integer scaling without margin - optimized bit packing
-            int bytes_per_row = (final_size + 7) / 8;
-            std::vector<unsigned char> packed_data(bytes_per_row * final_size, 0);
-
-            std::vector<unsigned char> template_row(bytes_per_row);
-
-            for (int src_y = 0; src_y < qr_size; src_y++) {
-                std::memset(template_row.data(), 0, bytes_per_row);
-
-                for (int src_x = 0; src_x < qr_size; src_x++) {
-                    if (qr_data[src_y * qr_size + src_x] & 1) {
-                        // Black pixel - set all bits for scaled pixels
-                        int dst_x_start = src_x * scale;
-                        int dst_x_end = dst_x_start + scale;
-
-                        for (int dst_x = dst_x_start; dst_x < dst_x_end; dst_x++) {
-                            int byte_idx = dst_x >> 3;
-                            int bit_idx = 7 - (dst_x & 7);
-                            template_row[byte_idx] |= (1 << bit_idx);
-                        }
-                    }
-                }
-
-                // Copy template row to all scaled rows
-                int dst_y_start = src_y * scale;
-                for (int dy = 0; dy < scale; dy++) {
-                    std::memcpy(&packed_data[(dst_y_start + dy) * bytes_per_row],
-                               template_row.data(), bytes_per_row);
-                }
-            }
-
-            return write_indexed_png(output_path.c_str(), packed_data, final_size, final_size);
-        } else if (scale * qr_size == inner_size && margin > 0) {
-            int bytes_per_row = (final_size + 7) / 8;
-            std::vector<unsigned char> packed_data(bytes_per_row * final_size, 0);
-
-            std::vector<unsigned char> template_row(bytes_per_row);
-
-            for (int src_y = 0; src_y < qr_size; src_y++) {
-                std::memset(template_row.data(), 0, bytes_per_row);
-
-                for (int src_x = 0; src_x < qr_size; src_x++) {
-                    if (qr_data[src_y * qr_size + src_x] & 1) {
-                        int dst_x_start = margin + src_x * scale;
-                        int dst_x_end = dst_x_start + scale;
-
-                        for (int dst_x = dst_x_start; dst_x < dst_x_end; dst_x++) {
-                            int byte_idx = dst_x >> 3;
-                            int bit_idx = 7 - (dst_x & 7);
-                            template_row[byte_idx] |= (1 << bit_idx);
-                        }
-                    }
-                }
-
-                int dst_y_start = margin + src_y * scale;
-                for (int dy = 0; dy < scale; dy++) {
-                    std::memcpy(&packed_data[(dst_y_start + dy) * bytes_per_row],
-                               template_row.data(), bytes_per_row);
-                }
-            }
-
-            return write_indexed_png(output_path.c_str(), packed_data, final_size, final_size);
-        } else {
-            // Non-integer scaling - use grayscale
-            std::vector<unsigned char> final_image(final_size * final_size, 255);  // Fill with white
-            double x_ratio = static_cast<double>(qr_size) / inner_size;
-            double y_ratio = static_cast<double>(qr_size) / inner_size;
-
-            for (int y = 0; y < inner_size; y++) {
-                int src_y = static_cast<int>(y * y_ratio);
-                int src_row_idx = src_y * qr_size;
-                for (int x = 0; x < inner_size; x++) {
-                    int src_x = static_cast<int>(x * x_ratio);
-                    int dst_y = margin + y;
-                    int dst_x = margin + x;
-                    final_image[dst_y * final_size + dst_x] = (qr_data[src_row_idx + src_x] & 1) ? 0 : 255;
-                }
-            }
+    std::vector<unsigned char> pixels;
+    if (is_bw && !has_logo && image.integer_scale) {
+        // FASTEST PATH: 1-bit indexed PNG (like qrencode), 8 pixels per byte
+        render(Packed1Format(), IntegerScale{inner_size / qr_size}, qr, final_size, margin, pixels);
+        return finish_image(image, Packed1Format::FORMAT, final_size, pixels);
+    }
 
-            // Add logo if specified
-            if (!options.logo_path.empty()) {
-                add_logo_to_image(final_image, final_size, 1, options.logo_path, options.logo_size_percent);
-            }
+    if (is_bw && !has_logo) {
+        // Non-integer scaling - use grayscale
+        render_scaled(Gray8Format{0, 255}, options.scaling, qr, final_size, margin, pixels);
+        return finish_image(image, Gray8Format::FORMAT, final_size, pixels);
+    }
 
-            return write_grayscale_png(output_path.c_str(), final_image, final_size, final_size);
-        }
-    } else if (is_bw) {
-        // Black/white but with logo - use RGB to preserve logo colors
-        std::vector<unsigned char> final_image(final_size * final_size * 3, 255);  // Fill with white
-        int scale = inner_size / qr_size;
-
-        if (scale * qr_size == inner_size) {
-            // Integer scaling
-            std::vector<unsigned char> scaled_row(final_size * 3, 255);
-
-            for (int src_y = 0; src_y < qr_size; src_y++) {
-                std::memset(scaled_row.data(), 255, final_size * 3);
-
-                for (int src_x = 0; src_x < qr_size; src_x++) {
-                    unsigned char val = (qr_data[src_y * qr_size + src_x] & 1) ? 0 : 255;
-                    int dst_x_start = margin + src_x * scale;
-                    for (int dx = 0; dx < scale; dx++) {
-                        int idx = (dst_x_start + dx) * 3;
-                        scaled_row[idx] = scaled_row[idx + 1] = scaled_row[idx + 2] = val;
-                    }
-                }
+    bool is_grayscale = (options.foreground.r == options.foreground.g &&
+                         options.foreground.g == options.foreground.b &&
+                         options.background.r == options.background.g &&
+                         options.background.g == options.background.b);
 
-                int dst_y_start = margin + src_y * scale;
-                unsigned char* dst_ptr = &final_image[dst_y_start * final_size * 3];
-                std::memcpy(dst_ptr, scaled_row.data(), final_size * 3);
-                for (int dy = 1; dy < scale; dy++) {
-                    std::memcpy(dst_ptr + dy * final_size * 3, dst_ptr, final_size * 3);
-                }
-            }
-        } else {
-            // Non-integer scaling
-            double x_ratio = static_cast<double>(qr_size) / inner_size;
-            double y_ratio = static_cast<double>(qr_size) / inner_size;
-
-            for (int y = 0; y < inner_size; y++) {
-                int src_y = static_cast<int>(y * y_ratio);
-                int src_row_idx = src_y * qr_size;
-                for (int x = 0; x < inner_size; x++) {
-                    int src_x = static_cast<int>(x * x_ratio);
-                    unsigned char val = (qr_data[src_row_idx + src_x] & 1) ? 0 : 255;
-                    int dst_y = margin + y;
-                    int dst_x = margin + x;
-                    int idx = (dst_y * final_size + dst_x) * 3;
-                    final_image[idx] = final_image[idx + 1] = final_image[idx + 2] = val;
-                }
-            }
+    if (is_grayscale && !is_bw) {
+        // Gray colors - 8-bit grayscale PNG
+        Gray8Format gray{options.foreground.r, options.background.r};
+        render_scaled(gray, options.scaling, qr, final_size, margin, pixels);
+        if (has_logo) {
+            add_logo_to_image(pixels, final_size, 1, options.logo_path, options.logo_size_percent);
         }
+        return finish_image(image, Gray8Format::FORMAT, final_size, pixels);
+    }
 
-        // Add logo (RGB)
-        add_logo_to_image(final_image, final_size, 3, options.logo_path, options.logo_size_percent);
+    // COLOR PATH: RGB for custom colors, and for black/white with a logo
+    // (to preserve the logo's colors)
+    Rgb8Format rgb(options.foreground, options.background);
+    render_scaled(rgb, options.scaling, qr, final_size, margin, pixels);
+    if (has_logo) {
+        add_logo_to_image(pixels, final_size, 3, options.logo_path, options.logo_size_percent);
+    }
+    return finish_image(image, Rgb8Format::FORMAT, final_size, pixels);
+}
 
-        return write_rgb_png(output_path.c_str(), final_image, final_size, final_size);
-    } else {
-        // COLOR PATH: RGB output for custom colors
-        bool is_grayscale = (options.foreground.r == options.foreground.g &&
-                            options.foreground.g == options.foreground.b &&
-                            options.background.r == options.background.g &&
-                            options.background.g == options.background.b);
-
-        if (is_grayscale) {
-            // Use grayscale PNG
-            unsigned char fg = options.foreground.r;
-            unsigned char bg = options.background.r;
-            std::vector<unsigned char> final_image(final_size * final_size, bg);  // Fill with background
-
-            int scale = inner_size / qr_size;
-            if (scale * qr_size == inner_size) {
-                // Integer scaling
-                std::vector<unsigned char> scaled_row(final_size, bg);
-
-                for (int src_y = 0; src_y < qr_size; src_y++) {
-                    std::memset(scaled_row.data(), bg, final_size);
-
-                    for (int src_x = 0; src_x < qr_size; src_x++) {
-                        unsigned char val = (qr_data[src_y * qr_size + src_x] & 1) ? fg : bg;
-                        int dst_x_start = margin + src_x * scale;
-                        std::memset(&scaled_row[dst_x_start], val, scale);
-                    }
+bool detail::write_png(const PngSink& sink, const RasterImage& image, GenerateStats* stats) {
+    uint64_t start = stats ? now_ns() : 0;
 
-                    int dst_y_start = margin + src_y * scale;
-                    unsigned char* dst_ptr = &final_image[dst_y_start * final_size];
-                    std::memcpy(dst_ptr, scaled_row.data(), final_size);
-                    for (int dy = 1; dy < scale; dy++) {
-                        std::memcpy(dst_ptr + dy * final_size, dst_ptr, final_size);
-                    }
-                }
-            } else {
-                // Non-integer scaling
-                double x_ratio = static_cast<double>(qr_size) / inner_size;
-                double y_ratio = static_cast<double>(qr_size) / inner_size;
-
-                for (int y = 0; y < inner_size; y++) {
-                    int src_y = static_cast<int>(y * y_ratio);
-                    int src_row_idx = src_y * qr_size;
-                    for (int x = 0; x < inner_size; x++) {
-                        int src_x = static_cast<int>(x * x_ratio);
-                        int dst_y = margin + y;
-                        int dst_x = margin + x;
-                        final_image[dst_y * final_size + dst_x] = (qr_data[src_row_idx + src_x] & 1) ? fg : bg;
-                    }
-                }
-            }
+    FILE* fp = open_sink(sink);
+    if (sink.filename && !fp) return false;
 
-            // Add logo if specified
-            if (!options.logo_path.empty()) {
-                add_logo_to_image(final_image, final_size, 1, options.logo_path, options.logo_size_percent);
-            }
+    bool ok = false;
+    switch (image.format) {
+        case PixelFormat::INDEXED_1BIT:
+            ok = write_indexed_png(sink, fp, image.pixels, image.width, image.height);
+            break;
+        case PixelFormat::GRAY8:
+            ok = write_grayscale_png(sink, fp, image.pixels, image.width, image.height);
+            break;
+        case PixelFormat::RGB8:
+            ok = write_rgb_png(sink, fp, image.pixels, image.width, image.height);
+            break;
+    }
 
-            return write_grayscale_png(output_path.c_str(), final_image, final_size, final_size);
-        } else {
-            // Full RGB for non-grayscale colors
-            std::vector<unsigned char> final_image(final_size * final_size * 3);
-            
-            for (int i = 0; i < final_size * final_size; i++) {
-                final_image[i * 3] = options.background.r;
-                final_image[i * 3 + 1] = options.background.g;
-                final_image[i * 3 + 2] = options.background.b;
-            }
+    uint64_t compressed = 0;
+    if (stats) {
+        compressed = now_ns();
+        stats->compress_ns = compressed - start;
+        stats->output_bytes = fp ? static_cast<size_t>(ftell(fp)) : sink.buffer->size();
+    }
 
-            int scale = inner_size / qr_size;
-            if (scale * qr_size == inner_size) {
-                // Integer scaling
-                std::vector<unsigned char> scaled_row(final_size * 3);
+    // fclose flushes the stdio buffer - time it separately from compression
+    bool is_file = fp != nullptr;
+    if (!close_sink(fp)) ok = false;
+    if (stats && is_file) {
+        stats->write_ns = now_ns() - compressed;
+    }
+    return ok;
+}
 
-                for (int src_y = 0; src_y < qr_size; src_y++) {
-                    for (int i = 0; i < final_size; i++) {
-                        scaled_row[i * 3] = options.background.r;
-                        scaled_row[i * 3 + 1] = options.background.g;
-                        scaled_row[i * 3 + 2] = options.background.b;
-                    }
+bool detail::generate_png(const std::string& data, const PngSink& sink, const QROptions& options,
+                          GenerateStats* stats) {
+    uint64_t start = 0;
+    if (stats) {
+        *stats = GenerateStats();
+        start = now_ns();
+    }
 
-                    for (int src_x = 0; src_x < qr_size; src_x++) {
-                        bool is_black = qr_data[src_y * qr_size + src_x] & 1;
-                        unsigned char r = is_black ? options.foreground.r : options.background.r;
-                        unsigned char g = is_black ? options.foreground.g : options.background.g;
-                        unsigned char b = is_black ? options.foreground.b : options.background.b;
-
-                        int dst_x_start = margin + src_x * scale;
-                        for (int dx = 0; dx < scale; dx++) {
-                            int idx = (dst_x_start + dx) * 3;
-                            scaled_row[idx] = r;
-                            scaled_row[idx + 1] = g;
-                            scaled_row[idx + 2] = b;
-                        }
-                    }
+    bool cached = false;
+    std::shared_ptr<const detail::QRMatrix> qr = detail::encode_qr_cached(data, options, &cached);
+    if (!qr) {
+        return false;
+    }
 
-                    int dst_y_start = margin + src_y * scale;
-                    unsigned char* dst_ptr = &final_image[dst_y_start * final_size * 3];
-                    std::memcpy(dst_ptr, scaled_row.data(), final_size * 3);
-                    for (int dy = 1; dy < scale; dy++) {
-                        std::memcpy(dst_ptr + dy * final_size * 3, dst_ptr, final_size * 3);
-                    }
-                }
-            } else {
-                // Non-integer scaling
-                double x_ratio = static_cast<double>(qr_size) / inner_size;
-                double y_ratio = static_cast<double>(qr_size) / inner_size;
-
-                for (int y = 0; y < inner_size; y++) {
-                    int src_y = static_cast<int>(y * y_ratio);
-                    int src_row_idx = src_y * qr_size;
-                    for (int x = 0; x < inner_size; x++) {
-                        int src_x = static_cast<int>(x * x_ratio);
-                        bool is_black = qr_data[src_row_idx + src_x] & 1;
-                        int dst_y = margin + y;
-                        int dst_x = margin + x;
-                        int idx = (dst_y * final_size + dst_x) * 3;
-                        final_image[idx] = is_black ? options.foreground.r : options.background.r;
-                        final_image[idx + 1] = is_black ? options.foreground.g : options.background.g;
-                        final_image[idx + 2] = is_black ? options.foreground.b : options.background.b;
-                    }
-                }
-            }
+    if (stats) {
+        uint64_t now = now_ns();
+        stats->encode_ns = now - start;
+        stats->matrix_cached = cached;
+        stats->qr_version = qr->version;
+        stats->qr_width = qr->width;
+        start = now;
+    }
 
-            // Add logo if specified
-            if (!options.logo_path.empty()) {
-                add_logo_to_image(final_image, final_size, 3, options.logo_path, options.logo_size_percent);
-            }
+    detail::RasterImage image;
+    if (!detail::rasterize(*qr, options, image)) {
+        return false;
+    }
 
-            return write_rgb_png(output_path.c_str(), final_image, final_size, final_size);
+    if (stats) {
+        stats->rasterize_ns = now_ns() - start;
+        switch (image.format) {
+            case detail::PixelFormat::INDEXED_1BIT: stats->path = RenderPath::INDEXED; break;
+            case detail::PixelFormat::GRAY8: stats->path = RenderPath::GRAYSCALE; break;
+            case detail::PixelFormat::RGB8: stats->path = RenderPath::RGB; break;
         }
+        stats->logo = !options.logo_path.empty();
+        stats->integer_scale = image.integer_scale;
+        stats->image_size = image.width;
     }
+
+    return detail::write_png(sink, image, stats);
+}
+
+bool generate(const std::string& data, const std::string& output_path, const QROptions& options,
+              GenerateStats* stats) {
+    PngSink sink;
+    sink.filename = output_path.c_str();
+    return detail::generate_png_cached(data, sink, options, stats);
 }
 
 int generate_to_buffer(const std::string& data, void* buffer, size_t buffer_size, const QROptions& options) {
-    // For buffer generation, temporarily write to a temp file then read it back
-    // This is a simplified implementation - could be optimized to write directly to memory
-    std::string temp_file = "/tmp/fastqr_temp.png";
+    return generate_to_buffer(data, buffer, buffer_size, nullptr, options);
+}
+
+int generate_to_buffer(const std::string& data, void* buffer, size_t buffer_size, size_t* required_size,
+                       const QROptions& options, GenerateStats* stats) {
+    if (required_size) *required_size = 0;
 
-    if (!generate(data, temp_file, options)) {
+    std::vector<uint8_t> png_data;
+    if (!generate_to_buffer(data, png_data, options, stats)) {
         return -1;
     }
 
-    FILE* fp = fopen(temp_file.c_str(), "rb");
-    if (!fp) return -1;
+    if (required_size) *required_size = png_data.size();
 
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    if (static_cast<size_t>(file_size) > buffer_size) {
-        fclose(fp);
-        std::remove(temp_file.c_str());
+    if (png_data.size() > buffer_size || !buffer) {
         return -1;
     }
 
-    size_t read_size = fread(buffer, 1, file_size, fp);
-    fclose(fp);
-    std::remove(temp_file.c_str());
+    std::memcpy(buffer, png_data.data(), png_data.size());
+    return static_cast<int>(png_data.size());
+}
 
-    return static_cast<int>(read_size);
+bool generate_to_buffer(const std::string& data, std::vector<uint8_t>& output, const QROptions& options,
+                        GenerateStats* stats) {
+    // Encode straight into memory via libpng write callbacks - no temp file,
+    // no shared state, so concurrent calls never interfere
+    output.clear();
+    PngSink sink;
+    sink.buffer = &output;
+
+    return detail::generate_png_cached(data, sink, options, stats);
 }
 
 const char* version() {
@@ -726,11 +614,8 @@ const char* version() {
 
 extern "C" {
 
-int fastqr_generate(const char* data, const char* output_path, const QROptions* c_options) {
-    if (!data || !output_path) {
-        return 0;
-    }
-
+// Convert C options to C++ options (NULL means defaults)
+static fastqr::QROptions to_cpp_options(const QROptions* c_options) {
     fastqr::QROptions options;
 
     if (c_options) {
@@ -764,10 +649,53 @@ int fastqr_generate(const char* data, const char* output_path, const QROptions*
         options.margin_modules = c_options->margin_modules;
     }
 
-    bool result = fastqr::generate(data, output_path, options);
+    return options;
+}
+
+int fastqr_generate(const char* data, const char* output_path, const QROptions* c_options) {
+    if (!data || !output_path) {
+        return 0;
+    }
+
+    bool result = fastqr::generate(data, output_path, to_cpp_options(c_options));
     return result ? 1 : 0;
 }
 
+int fastqr_generate_to_buffer(const char* data, unsigned char* buffer, size_t buffer_size,
+                              size_t* required_size, const QROptions* c_options) {
+    if (required_size) *required_size = 0;
+    if (!data) {
+        return -1;
+    }
+
+    return fastqr::generate_to_buffer(data, buffer, buffer_size, required_size, to_cpp_options(c_options));
+}
+
+unsigned char* fastqr_generate_buffer(const char* data, const QROptions* c_options, size_t* size) {
+    if (size) *size = 0;
+    if (!data) {
+        return nullptr;
+    }
+
+    std::vector<uint8_t> png_data;
+    if (!fastqr::generate_to_buffer(data, png_data, to_cpp_options(c_options))) {
+        return nullptr;
+    }
+
+    // malloc so callers in any language can hand it back to fastqr_free_buffer
+    unsigned char* buffer = static_cast<unsigned char*>(std::malloc(png_data.size()));
+    if (!buffer) {
+        return nullptr;
+    }
+    std::memcpy(buffer, png_data.data(), png_data.size());
+    if (size) *size = png_data.size();
+    return buffer;
+}
+
+void fastqr_free_buffer(unsigned char* buffer) {
+    std::free(buffer);
+}
+
 const char* fastqr_version(void) {
     return fastqr::version();
 }
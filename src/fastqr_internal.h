@@ -0,0 +1,91 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_INTERNAL_H
+#define FASTQR_INTERNAL_H
+
+// Internal pipeline stages behind generate(). Not installed; used by the
+// library itself and by the benchmarks to time each stage in isolation.
+
+#include "fastqr.h"
+#include "qr_encoder.h"
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace fastqr {
+
+// Output target for the PNG writers: a file on disk or an in-memory buffer
+struct PngSink {
+    const char* filename = nullptr;
+    std::vector<uint8_t>* buffer = nullptr;
+};
+
+namespace detail {
+
+// Module matrix produced by the encode stage
+using QRMatrix = qr::Matrix;
+
+enum class PixelFormat {
+    INDEXED_1BIT,  // 8 pixels per byte, 1 = black
+    GRAY8,
+    RGB8
+};
+
+// Rasterized image ready for PNG encoding
+struct RasterImage {
+    PixelFormat format = PixelFormat::GRAY8;
+    int width = 0;
+    int height = 0;
+    bool integer_scale = false;  // Whole pixels per module
+    std::vector<unsigned char> pixels;
+};
+
+// Stage 1: text -> module matrix (uses ec_level, mask and segmentation)
+bool encode_qr(const std::string& data, const QROptions& options, QRMatrix& matrix);
+
+// Stage 1 through the matrix cache (see set_matrix_cache()): the cached
+// matrix on a hit, otherwise a fresh encode_qr() result that is then
+// cached. Null if encoding fails. `hit` (if not NULL) tells which.
+std::shared_ptr<const QRMatrix> encode_qr_cached(const std::string& data, const QROptions& options,
+                                                 bool* hit = nullptr);
+
+// Stage 2: module matrix -> pixels (scaling, margin, colors, logo)
+bool rasterize(const QRMatrix& qr, const QROptions& options, RasterImage& image);
+
+// Stage 3: pixels -> PNG (fills the compress/write fields of stats)
+bool write_png(const PngSink& sink, const RasterImage& image, GenerateStats* stats = nullptr);
+
+// All three stages into a sink, bypassing the output cache
+bool generate_png(const std::string& data, const PngSink& sink, const QROptions& options, GenerateStats* stats);
+
+// generate_png() through the output cache (see set_output_cache()): a
+// cached image is copied to a buffer sink or written as a copy to a file
+// sink. Plain generate_png() when the cache is off.
+bool generate_png_cached(const std::string& data, const PngSink& sink, const QROptions& options,
+                         GenerateStats* stats);
+
+// Monotonic clock for GenerateStats
+uint64_t now_ns();
+
+} // namespace detail
+} // namespace fastqr
+
+#endif // FASTQR_INTERNAL_H
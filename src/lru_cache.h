@@ -0,0 +1,212 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_LRU_CACHE_H
+#define FASTQR_LRU_CACHE_H
+
+// Bounded, thread-safe LRU map from string keys to immutable values.
+//
+// Keys are spread over SHARDS independently locked shards by hash, so
+// concurrent lookups rarely wait on each other. Each shard keeps its own
+// LRU list, but the entry and byte limits count across all of them: when
+// a put goes over, the oldest tail among the shards (by last-use tick) is
+// evicted until the cache fits, so it holds what it was configured for
+// however the keys hash. Values are handed out as shared_ptr so an evicted
+// value stays alive for callers still using it.
+
+#include "fastqr.h"
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace fastqr {
+namespace detail {
+
+template <class Value>
+class LruCache {
+public:
+    static const size_t SHARDS = 16;
+
+    // Disabled (max_entries 0) until set_limits() is called
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Change the limits, evicting what no longer fits
+     *
+     * @param max_entries Most entries kept, 0 disables the cache and frees it
+     * @param max_bytes Most bytes kept (keys plus value sizes), 0 = no limit
+     */
+    void set_limits(size_t max_entries, size_t max_bytes) {
+        max_entries_.store(max_entries, std::memory_order_relaxed);
+        max_bytes_.store(max_bytes, std::memory_order_relaxed);
+        enabled_.store(max_entries > 0, std::memory_order_relaxed);
+        trim();
+    }
+
+    // Cached value for `key` (marked most recently used), or null
+    std::shared_ptr<const Value> get(const std::string& key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            shard.misses++;
+            return nullptr;
+        }
+        shard.hits++;
+        it->second->tick = next_tick();
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->value;
+    }
+
+    // Store `value` (which accounts for `bytes`) under `key`, replacing any
+    // entry already there; skipped if it alone exceeds the byte limit
+    void put(const std::string& key, std::shared_ptr<const Value> value, size_t bytes) {
+        bytes += key.size();
+        size_t max_bytes = max_bytes_.load(std::memory_order_relaxed);
+        if (max_entries_.load(std::memory_order_relaxed) == 0 || (max_bytes && bytes > max_bytes)) return;
+
+        Shard& shard = shard_for(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto inserted = shard.index.emplace(key, shard.lru.end());
+            if (inserted.second) {
+                shard.lru.push_front(Node{&inserted.first->first, std::move(value), bytes, next_tick()});
+                inserted.first->second = shard.lru.begin();
+                entries_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                Node& node = *inserted.first->second;
+                shard.bytes -= node.bytes;
+                bytes_.fetch_sub(node.bytes, std::memory_order_relaxed);
+                node.value = std::move(value);
+                node.bytes = bytes;
+                node.tick = next_tick();
+                shard.lru.splice(shard.lru.begin(), shard.lru, inserted.first->second);
+            }
+            shard.bytes += bytes;
+            bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        trim();
+    }
+
+    // Drop every entry and reset the counters (limits are kept)
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            entries_.fetch_sub(shard.index.size(), std::memory_order_relaxed);
+            bytes_.fetch_sub(shard.bytes, std::memory_order_relaxed);
+            shard.index.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+            shard.hits = shard.misses = shard.evictions = 0;
+        }
+    }
+
+    CacheStats stats() const {
+        CacheStats stats;
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.entries += shard.index.size();
+            stats.bytes += shard.bytes;
+        }
+        stats.max_entries = max_entries_.load(std::memory_order_relaxed);
+        stats.max_bytes = max_bytes_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct Node {
+        const std::string* key;  // Owned by the index
+        std::shared_ptr<const Value> value;
+        size_t bytes;
+        uint64_t tick;           // Last use, comparable across shards
+    };
+
+    // Own cache line each, so shards locked by different threads do not
+    // contend through false sharing
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Node> lru;  // Most recently used first
+        std::unordered_map<std::string, typename std::list<Node>::iterator> index;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    Shard& shard_for(const std::string& key) {
+        return shards_[std::hash<std::string>()(key) % SHARDS];
+    }
+
+    uint64_t next_tick() { return tick_.fetch_add(1, std::memory_order_relaxed); }
+
+    bool over_limits() const {
+        size_t max_bytes = max_bytes_.load(std::memory_order_relaxed);
+        return entries_.load(std::memory_order_relaxed) > max_entries_.load(std::memory_order_relaxed) ||
+               (max_bytes && bytes_.load(std::memory_order_relaxed) > max_bytes);
+    }
+
+    // Evict least recently used entries, across all shards, until within
+    // the limits. Shards are locked one at a time, so the oldest tail is
+    // picked from a snapshot; a shard that changed since is looked at again.
+    void trim() {
+        while (over_limits()) {
+            Shard* oldest = nullptr;
+            uint64_t oldest_tick = 0;
+            for (Shard& shard : shards_) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                if (!shard.lru.empty() && (!oldest || shard.lru.back().tick < oldest_tick)) {
+                    oldest = &shard;
+                    oldest_tick = shard.lru.back().tick;
+                }
+            }
+            if (!oldest) return;
+
+            std::lock_guard<std::mutex> lock(oldest->mutex);
+            if (oldest->lru.empty() || oldest->lru.back().tick != oldest_tick || !over_limits()) continue;
+            Node& node = oldest->lru.back();
+            oldest->bytes -= node.bytes;
+            bytes_.fetch_sub(node.bytes, std::memory_order_relaxed);
+            entries_.fetch_sub(1, std::memory_order_relaxed);
+            oldest->index.erase(oldest->index.find(*node.key));
+            oldest->lru.pop_back();
+            oldest->evictions++;
+        }
+    }
+
+    Shard shards_[SHARDS];
+    std::atomic<bool> enabled_{false};
+    std::atomic<size_t> max_entries_{0};
+    std::atomic<size_t> max_bytes_{0};
+    std::atomic<size_t> entries_{0};   // Totals over all shards
+    std::atomic<size_t> bytes_{0};
+    std::atomic<uint64_t> tick_{0};
+};
+
+} // namespace detail
+} // namespace fastqr
+
+#endif // FASTQR_LRU_CACHE_H
@@ -0,0 +1,1058 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#include "qr_encoder.h"
+#include "reed_solomon.h"
+#include "text_class.h"
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+
+namespace fastqr {
+namespace qr {
+namespace {
+
+const int MAX_VERSION = 40;
+const int MAX_WIDTH = 17 + 4 * MAX_VERSION;    // 177
+const int ROW_WORDS = (MAX_WIDTH + 63) / 64;   // 64-bit words per packed row
+
+// ---------------------------------------------------------------------------
+// Version tables (ISO/IEC 18004 Table 9), indexed [level][version]: L, M, Q, H
+
+constexpr int8_t ECC_CODEWORDS_PER_BLOCK[4][41] = {
+    {-1,  7, 10, 15, 20, 26, 18, 20, 24, 30, 18, 20, 24, 26, 30, 22, 24, 28, 30, 28, 28,
+         28, 28, 30, 30, 26, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+    {-1, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26, 30, 22, 22, 24, 24, 28, 28, 26, 26, 26,
+         26, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28},
+    {-1, 13, 22, 18, 26, 18, 24, 18, 22, 20, 24, 28, 26, 24, 20, 30, 24, 28, 28, 26, 30,
+         28, 30, 30, 30, 30, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+    {-1, 17, 28, 22, 16, 22, 28, 26, 26, 24, 28, 24, 28, 22, 24, 24, 30, 28, 28, 26, 28,
+         30, 24, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+};
+
+constexpr int8_t NUM_ECC_BLOCKS[4][41] = {
+    {-1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4, 4, 4, 4, 4, 6, 6, 6, 6, 7, 8,
+         8, 9, 9, 10, 12, 12, 12, 13, 14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 24, 25},
+    {-1, 1, 1, 1, 2, 2, 4, 4, 4, 5, 5, 5, 8, 9, 9, 10, 10, 11, 13, 14, 16,
+         17, 17, 18, 20, 21, 23, 25, 26, 28, 29, 31, 33, 35, 37, 38, 40, 43, 45, 47, 49},
+    {-1, 1, 1, 2, 2, 4, 4, 6, 6, 8, 8, 8, 10, 12, 16, 12, 17, 16, 18, 21, 20,
+         23, 23, 25, 27, 29, 34, 34, 35, 38, 40, 43, 45, 48, 51, 53, 56, 59, 62, 65, 68},
+    {-1, 1, 1, 2, 4, 4, 4, 5, 6, 8, 8, 11, 11, 16, 16, 18, 16, 19, 21, 25, 25,
+         25, 34, 30, 32, 35, 37, 40, 42, 45, 48, 51, 54, 57, 60, 63, 66, 70, 74, 77, 81},
+};
+
+// Modules left for codewords once all function patterns are placed
+constexpr int raw_data_modules(int version) {
+    int result = (16 * version + 128) * version + 64;
+    if (version >= 2) {
+        int num_align = version / 7 + 2;
+        result -= (25 * num_align - 10) * num_align - 55;
+        if (version >= 7) result -= 36;
+    }
+    return result;
+}
+
+struct CapacityTable {
+    int16_t total_codewords[41];
+    int16_t data_codewords[4][41];
+};
+
+constexpr CapacityTable build_capacity_table() {
+    CapacityTable table{};
+    for (int v = 1; v <= MAX_VERSION; v++) {
+        int total = raw_data_modules(v) / 8;
+        table.total_codewords[v] = static_cast<int16_t>(total);
+        for (int l = 0; l < 4; l++) {
+            table.data_codewords[l][v] =
+                static_cast<int16_t>(total - ECC_CODEWORDS_PER_BLOCK[l][v] * NUM_ECC_BLOCKS[l][v]);
+        }
+    }
+    return table;
+}
+
+constexpr CapacityTable CAPACITY = build_capacity_table();
+
+static_assert(CAPACITY.data_codewords[0][1] == 19 && CAPACITY.data_codewords[3][1] == 9,
+              "version 1 capacity");
+static_assert(CAPACITY.data_codewords[0][40] == 2956 && CAPACITY.data_codewords[3][40] == 1276,
+              "version 40 capacity");
+
+// Format information level bits (L=01, M=00, Q=11, H=10)
+const int FORMAT_LEVEL_BITS[4] = {1, 0, 3, 2};
+
+// ---------------------------------------------------------------------------
+// Segmentation
+
+// Order matches libqrencode's QRencodeMode (indexes LENGTH_BITS)
+enum Mode { MODE_NUL = -1, MODE_NUM = 0, MODE_AN = 1, MODE_8 = 2, MODE_KANJI = 3 };
+
+const int NUM_MODES = 4;
+
+// Character count indicator width per mode for versions 1-9, 10-26, 27-40
+const int LENGTH_BITS[NUM_MODES][3] = {
+    {10, 12, 14},
+    { 9, 11, 13},
+    { 8, 16, 16},
+    { 8, 10, 12},
+};
+
+const uint32_t MODE_INDICATOR[NUM_MODES] = {0x1, 0x2, 0x4, 0x8};
+
+int length_bits(Mode mode, int version) {
+    int range = version <= 9 ? 0 : (version <= 26 ? 1 : 2);
+    return LENGTH_BITS[mode][range];
+}
+
+int alnum_value(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    switch (c) {
+        case ' ': return 36;
+        case '$': return 37;
+        case '%': return 38;
+        case '*': return 39;
+        case '+': return 40;
+        case '-': return 41;
+        case '.': return 42;
+        case '/': return 43;
+        case ':': return 44;
+        default: return -1;
+    }
+}
+
+inline bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool is_alnum(char c) {
+    return alnum_value(static_cast<unsigned char>(c)) >= 0;
+}
+
+int bits_num(int length) {
+    int bits = length / 3 * 10;
+    switch (length % 3) {
+        case 1: bits += 4; break;
+        case 2: bits += 7; break;
+    }
+    return bits;
+}
+
+int bits_an(int length) {
+    return length / 2 * 11 + ((length & 1) ? 6 : 0);
+}
+
+int bits_8(int length) {
+    return length * 8;
+}
+
+int bits_kanji(int length) {
+    return length * 13;
+}
+
+int data_bits(Mode mode, int length) {
+    switch (mode) {
+        case MODE_NUM: return bits_num(length);
+        case MODE_AN: return bits_an(length);
+        case MODE_KANJI: return bits_kanji(length);
+        default: return bits_8(length);
+    }
+}
+
+// A segment covers `length` characters starting at `data`: bytes for the
+// numeric, alphanumeric and 8-bit modes, UTF-8 sequences for Kanji mode
+struct Segment {
+    Mode mode;
+    const char* data;
+    int length;
+};
+
+// Greedy splitter ported from libqrencode (Split_eatNum / eatAn / eat8).
+// Decisions use the version 1-9 count indicator widths, like libqrencode
+// does before the version is known.
+class Splitter {
+public:
+    explicit Splitter(std::vector<Segment>& segments)
+        : segments_(segments),
+          ln_(length_bits(MODE_NUM, 0)),
+          la_(length_bits(MODE_AN, 0)),
+          l8_(length_bits(MODE_8, 0)) {}
+
+    void split(const char* str) {
+        while (*str != '\0') {
+            int length;
+            switch (identify(str)) {
+                case MODE_NUM: length = eat_num(str); break;
+                case MODE_AN: length = eat_an(str); break;
+                default: length = eat_8(str); break;
+            }
+            if (length == 0) break;
+            str += length;
+        }
+    }
+
+private:
+    std::vector<Segment>& segments_;
+    int ln_, la_, l8_;
+
+    static Mode identify(const char* p) {
+        if (*p == '\0') return MODE_NUL;
+        if (is_digit(*p)) return MODE_NUM;
+        if (is_alnum(*p)) return MODE_AN;
+        return MODE_8;
+    }
+
+    int append(Mode mode, const char* str, int length) {
+        segments_.push_back({mode, str, length});
+        return length;
+    }
+
+    int eat_num(const char* str) {
+        const char* p = str;
+        while (is_digit(*p)) p++;
+        int run = static_cast<int>(p - str);
+
+        Mode mode = identify(p);
+        if (mode == MODE_8) {
+            int dif = bits_num(run) + 4 + ln_ + bits_8(1) - bits_8(run + 1);
+            if (dif > 0) return eat_8(str);
+        }
+        if (mode == MODE_AN) {
+            int dif = bits_num(run) + 4 + ln_ + bits_an(1) - bits_an(run + 1);
+            if (dif > 0) return eat_an(str);
+        }
+        return append(MODE_NUM, str, run);
+    }
+
+    int eat_an(const char* str) {
+        const char* p = str;
+        while (is_alnum(*p)) {
+            if (is_digit(*p)) {
+                const char* q = p;
+                while (is_digit(*q)) q++;
+                int dif = bits_an(static_cast<int>(p - str)) + bits_num(static_cast<int>(q - p)) + 4 + ln_ +
+                          (is_alnum(*q) ? (4 + ln_) : 0) - bits_an(static_cast<int>(q - str));
+                if (dif < 0) break;
+                p = q;
+            } else {
+                p++;
+            }
+        }
+        int run = static_cast<int>(p - str);
+
+        if (*p != '\0' && !is_alnum(*p)) {
+            int dif = bits_an(run) + 4 + la_ + bits_8(1) - bits_8(run + 1);
+            if (dif > 0) return eat_8(str);
+        }
+        return append(MODE_AN, str, run);
+    }
+
+    int eat_8(const char* str) {
+        const char* p = str + 1;
+        while (*p != '\0') {
+            Mode mode = identify(p);
+            if (mode == MODE_NUM || mode == MODE_AN) {
+                const char* q = p;
+                int dif;
+                if (mode == MODE_NUM) {
+                    while (is_digit(*q)) q++;
+                } else {
+                    while (is_alnum(*q)) q++;
+                }
+                int swcost = identify(q) == MODE_8 ? 4 + l8_ : 0;
+                if (mode == MODE_NUM) {
+                    dif = bits_8(static_cast<int>(p - str)) + bits_num(static_cast<int>(q - p)) + 4 + ln_ +
+                          swcost - bits_8(static_cast<int>(q - str));
+                } else {
+                    dif = bits_8(static_cast<int>(p - str)) + bits_an(static_cast<int>(q - p)) + 4 + la_ +
+                          swcost - bits_8(static_cast<int>(q - str));
+                }
+                if (dif < 0) break;
+                p = q;
+            } else {
+                p++;
+            }
+        }
+        return append(MODE_8, str, static_cast<int>(p - str));
+    }
+};
+
+static_assert(CAN_NUM == 1 << MODE_NUM && CAN_AN == 1 << MODE_AN && CAN_8 == 1 << MODE_8 &&
+                  CAN_KANJI == 1 << MODE_KANJI,
+              "ModeBits follow Mode");
+
+// Shortest bit stream for `version`'s count indicator widths: a dynamic
+// program over the mode each character is written in (ISO/IEC 18004
+// Annex J). Costs are in sixths of a bit so numeric (10/3 bits) and
+// alphanumeric (11/2 bits) characters stay integral.
+//
+// `modes` comes from classify_text() on text whose TextClass::kanji is
+// set: characters start at the non-zero entries. 8-bit segments then only
+// ever carry ASCII - splitting other UTF-8 across segments would make each
+// 8-bit segment's charset a guess for the reader.
+void optimal_segments(const char* data, const uint8_t* modes, size_t n, int version,
+                      std::vector<Segment>& segments) {
+    const int UNIT = 6;
+    const int CHAR_COST[NUM_MODES] = {20, 33, 48, 78};
+    const int INF = INT_MAX / 2;
+
+    int head[NUM_MODES];
+    for (int m = 0; m < NUM_MODES; m++) {
+        head[m] = (4 + length_bits(static_cast<Mode>(m), version)) * UNIT;
+    }
+
+    // from[i][m]: mode of the character at byte i on the cheapest path that
+    // leaves a segment of mode m open after it (-1: unreachable)
+    std::vector<std::array<int8_t, NUM_MODES>> from(n);
+    int cost[NUM_MODES];
+    std::copy(head, head + NUM_MODES, cost);
+
+    size_t last = n;
+    for (size_t i = 0; i < n; i++) {
+        if (modes[i] == 0) continue;  // UTF-8 continuation byte
+        last = i;
+        int extended[NUM_MODES];
+        for (int m = 0; m < NUM_MODES; m++) {
+            bool fits = (modes[i] >> m) & 1;
+            extended[m] = fits ? cost[m] + CHAR_COST[m] : INF;
+            from[i][m] = static_cast<int8_t>(fits ? m : -1);
+        }
+        for (int m = 0; m < NUM_MODES; m++) {
+            cost[m] = extended[m];
+        }
+        // Close a segment after this character and open another one
+        for (int to = 0; to < NUM_MODES; to++) {
+            for (int m = 0; m < NUM_MODES; m++) {
+                if (extended[m] == INF) continue;
+                int switched = (extended[m] + UNIT - 1) / UNIT * UNIT + head[to];
+                if (switched < cost[to]) {
+                    cost[to] = switched;
+                    from[i][to] = static_cast<int8_t>(m);
+                }
+            }
+        }
+    }
+
+    segments.clear();
+    if (last == n) return;
+
+    // Walk back from the cheapest final state; `from` is reused to hold
+    // the chosen mode of each character
+    int state = 0;
+    for (int m = 1; m < NUM_MODES; m++) {
+        if (cost[m] < cost[state]) state = m;
+    }
+    for (size_t i = last + 1; i-- > 0;) {
+        if (modes[i] == 0) continue;
+        state = from[i][state];
+        from[i][0] = static_cast<int8_t>(state);
+    }
+
+    for (size_t i = 0; i < n;) {
+        Mode mode = static_cast<Mode>(from[i][0]);
+        int count = 0;
+        size_t j = i;
+        while (j < n && (modes[j] == 0 || from[j][0] == mode)) {
+            if (modes[j] != 0) count++;
+            j++;
+        }
+        segments.push_back({mode, data + i, count});
+        i = j;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Bit stream and version selection
+
+class BitBuffer {
+public:
+    explicit BitBuffer(size_t capacity_bytes) { bytes_.reserve(capacity_bytes); }
+
+    void append(uint32_t value, int count) {
+        for (int i = count - 1; i >= 0; i--) {
+            if ((bits_ & 7) == 0) bytes_.push_back(0);
+            if ((value >> i) & 1) bytes_.back() |= static_cast<uint8_t>(0x80 >> (bits_ & 7));
+            bits_++;
+        }
+    }
+
+    int bits() const { return bits_; }
+    std::vector<uint8_t>& bytes() { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+    int bits_ = 0;
+};
+
+// libqrencode's size estimate (QRinput_estimateBitStreamSize)
+int estimate_bits(const std::vector<Segment>& segments, int version) {
+    if (version == 0) version = 1;
+    int bits = 0;
+    for (const Segment& seg : segments) {
+        int l = length_bits(seg.mode, version);
+        int chunks = (seg.length + (1 << l) - 1) >> l;
+        bits += data_bits(seg.mode, seg.length) + chunks * (4 + l);
+    }
+    return bits;
+}
+
+// Exact size; segments longer than the count field allows are split
+int stream_bits(const std::vector<Segment>& segments, int version) {
+    int bits = 0;
+    for (const Segment& seg : segments) {
+        int l = length_bits(seg.mode, version);
+        int max_chars = (1 << l) - 1;
+        for (int done = 0; done < seg.length; done += max_chars) {
+            bits += 4 + l + data_bits(seg.mode, std::min(max_chars, seg.length - done));
+        }
+    }
+    return bits;
+}
+
+// Smallest version holding `bytes` data codewords (40 if none does)
+int minimum_version(int bytes, int level) {
+    for (int v = 1; v <= MAX_VERSION; v++) {
+        if (CAPACITY.data_codewords[level][v] >= bytes) return v;
+    }
+    return MAX_VERSION;
+}
+
+// Same iteration as libqrencode's QRinput_convertData()
+int select_version(const std::vector<Segment>& segments, int level) {
+    int version = 0;
+    int prev;
+    do {
+        prev = version;
+        version = minimum_version((estimate_bits(segments, prev) + 7) / 8, level);
+    } while (version > prev);
+
+    for (;;) {
+        int needed = minimum_version((stream_bits(segments, version) + 7) / 8, level);
+        if (needed <= version) return version;
+        version = needed;
+    }
+}
+
+// Smallest version holding the optimal segmentation. Count indicator
+// widths change at versions 10 and 27, so each range is solved on its own.
+int optimal_version(const char* data, const uint8_t* modes, size_t n, int level, std::vector<Segment>& segments) {
+    const int RANGE_LAST[3] = {9, 26, MAX_VERSION};
+    int first = 1;
+    int version = MAX_VERSION;
+    for (int last : RANGE_LAST) {
+        optimal_segments(data, modes, n, last, segments);
+        version = std::max(first, minimum_version((stream_bits(segments, last) + 7) / 8, level));
+        if (version <= last) break;
+        first = last + 1;
+    }
+    return std::min(version, MAX_VERSION);
+}
+
+void write_segments(const std::vector<Segment>& segments, int version, BitBuffer& bb) {
+    for (const Segment& seg : segments) {
+        int l = length_bits(seg.mode, version);
+        int max_chars = (1 << l) - 1;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(seg.data);
+        for (int done = 0; done < seg.length; done += max_chars) {
+            int length = std::min(max_chars, seg.length - done);
+
+            bb.append(MODE_INDICATOR[seg.mode], 4);
+            bb.append(length, l);
+            switch (seg.mode) {
+                case MODE_NUM: {
+                    int i = 0;
+                    for (; i + 3 <= length; i += 3) {
+                        bb.append((p[i] - '0') * 100 + (p[i + 1] - '0') * 10 + (p[i + 2] - '0'), 10);
+                    }
+                    if (length - i == 2) bb.append((p[i] - '0') * 10 + (p[i + 1] - '0'), 7);
+                    else if (length - i == 1) bb.append(p[i] - '0', 4);
+                    break;
+                }
+                case MODE_AN: {
+                    int i = 0;
+                    for (; i + 2 <= length; i += 2) {
+                        bb.append(alnum_value(p[i]) * 45 + alnum_value(p[i + 1]), 11);
+                    }
+                    if (i < length) bb.append(alnum_value(p[i]), 6);
+                    break;
+                }
+                case MODE_KANJI:
+                    // Validated by classify_text(); p advances per sequence
+                    for (int i = 0; i < length; i++) {
+                        uint32_t cp;
+                        p += decode_utf8(p, p + 4, cp);
+                        bb.append(kanji_value(cp), 13);
+                    }
+                    continue;
+                default:
+                    for (int i = 0; i < length; i++) {
+                        bb.append(p[i], 8);
+                    }
+                    break;
+            }
+            p += length;
+        }
+    }
+}
+
+// Terminator, byte alignment and 0xEC/0x11 pad codewords
+void append_padding(BitBuffer& bb, int data_codewords) {
+    int max_bits = data_codewords * 8;
+    int bits = bb.bits();
+    if (max_bits - bits <= 4) {
+        bb.append(0, max_bits - bits);
+        return;
+    }
+    int words = (bits + 4 + 7) / 8;
+    bb.append(0, words * 8 - bits);
+    for (int i = 0; words + i < data_codewords; i++) {
+        bb.append((i & 1) ? 0x11 : 0xEC, 8);
+    }
+}
+
+// Split data into blocks, append ECC and interleave
+std::vector<uint8_t> add_ecc_and_interleave(const std::vector<uint8_t>& data, int version, int level) {
+    int num_blocks = NUM_ECC_BLOCKS[level][version];
+    int ecc_len = ECC_CODEWORDS_PER_BLOCK[level][version];
+    int raw = CAPACITY.total_codewords[version];
+    int num_short = num_blocks - raw % num_blocks;
+    int short_data_len = raw / num_blocks - ecc_len;
+    int data_len = static_cast<int>(data.size());
+
+    std::vector<uint8_t> result(raw);
+    for (int b = 0; b < num_blocks; b++) {
+        int start = b * short_data_len + std::max(0, b - num_short);
+        int len = short_data_len + (b < num_short ? 0 : 1);
+        for (int i = 0; i < short_data_len; i++) {
+            result[i * num_blocks + b] = data[start + i];
+        }
+        if (len > short_data_len) {
+            // Extra codeword of the long blocks, after the full rows
+            result[short_data_len * num_blocks + b - num_short] = data[start + short_data_len];
+        }
+    }
+
+    // ECC codeword j of block b lands at data_len + j * num_blocks + b;
+    // short and long blocks are two groups of equal length
+    const RsGenerator& gen = rs_generator(ecc_len);
+    uint8_t* ecc = &result[data_len];
+    rs_encode_group(gen, data.data(), short_data_len, num_short, ecc, num_blocks);
+    rs_encode_group(gen, data.data() + num_short * short_data_len, short_data_len + 1, num_blocks - num_short,
+                    ecc + num_short, num_blocks);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Symbol construction on bit-packed rows
+
+using Rows = uint64_t[MAX_WIDTH][ROW_WORDS];
+
+// Everything about a symbol that depends on the version only
+struct Template {
+    int width = 0;
+    Rows dark;      // Function pattern modules, 1 = dark (data and format areas 0)
+    Rows function;  // 1 = function pattern / reserved (never masked)
+    // Data modules in zigzag placement order, as a bit index into Rows:
+    // (y * ROW_WORDS + x / 64) * 64 + x % 64
+    std::vector<uint16_t> placement;
+};
+
+static_assert(MAX_WIDTH * ROW_WORDS * 64 <= 65536, "placement fits 16 bits");
+
+inline bool get_bit(const Rows& rows, int x, int y) {
+    return (rows[y][x >> 6] >> (x & 63)) & 1;
+}
+
+inline void put_bit(Rows& rows, int x, int y, bool on) {
+    uint64_t bit = uint64_t(1) << (x & 63);
+    if (on) rows[y][x >> 6] |= bit;
+    else rows[y][x >> 6] &= ~bit;
+}
+
+inline void set_function(Template& f, int x, int y, bool dark) {
+    put_bit(f.function, x, y, true);
+    put_bit(f.dark, x, y, dark);
+}
+
+int alignment_positions(int version, int* out) {
+    if (version == 1) return 0;
+    int count = version / 7 + 2;
+    int width = 17 + 4 * version;
+    int step = (version == 32) ? 26 : (version * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+    out[0] = 6;
+    for (int i = count - 1, pos = width - 7; i >= 1; i--, pos -= step) {
+        out[i] = pos;
+    }
+    return count;
+}
+
+uint32_t format_bits(int level, int mask) {
+    uint32_t data = static_cast<uint32_t>(FORMAT_LEVEL_BITS[level] << 3 | mask);
+    uint32_t rem = data;
+    for (int i = 0; i < 10; i++) {
+        rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+    }
+    return ((data << 10) | rem) ^ 0x5412;
+}
+
+uint32_t version_bits(int version) {
+    uint32_t rem = static_cast<uint32_t>(version);
+    for (int i = 0; i < 12; i++) {
+        rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+    }
+    return static_cast<uint32_t>(version) << 12 | rem;
+}
+
+// Both copies of the 15 format bits
+void draw_format(Rows& dark, Rows* function, int width, uint32_t bits) {
+    auto put = [&](int x, int y, int i) {
+        put_bit(dark, x, y, (bits >> i) & 1);
+        if (function) put_bit(*function, x, y, true);
+    };
+    for (int i = 0; i <= 5; i++) put(8, i, i);
+    put(8, 7, 6);
+    put(8, 8, 7);
+    put(7, 8, 8);
+    for (int i = 9; i < 15; i++) put(14 - i, 8, i);
+    for (int i = 0; i < 8; i++) put(width - 1 - i, 8, i);
+    for (int i = 8; i < 15; i++) put(8, width - 15 + i, i);
+}
+
+void draw_function_patterns(Template& f, int version) {
+    int width = f.width;
+
+    // Timing patterns
+    for (int i = 0; i < width; i++) {
+        set_function(f, 6, i, i % 2 == 0);
+        set_function(f, i, 6, i % 2 == 0);
+    }
+
+    // Finder patterns with separators
+    const int finder_centers[3][2] = {{3, 3}, {width - 4, 3}, {3, width - 4}};
+    for (const auto& c : finder_centers) {
+        for (int dy = -4; dy <= 4; dy++) {
+            for (int dx = -4; dx <= 4; dx++) {
+                int x = c[0] + dx, y = c[1] + dy;
+                if (x < 0 || x >= width || y < 0 || y >= width) continue;
+                int dist = std::max(std::abs(dx), std::abs(dy));
+                set_function(f, x, y, dist != 2 && dist != 4);
+            }
+        }
+    }
+
+    // Alignment patterns (skipping the three finder corners)
+    int pos[7];
+    int count = alignment_positions(version, pos);
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < count; j++) {
+            if ((i == 0 && j == 0) || (i == 0 && j == count - 1) || (i == count - 1 && j == 0)) continue;
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    set_function(f, pos[i] + dx, pos[j] + dy, std::max(std::abs(dx), std::abs(dy)) != 1);
+                }
+            }
+        }
+    }
+
+    // Reserve format areas (real bits are drawn per mask) and the dark module
+    draw_format(f.dark, &f.function, width, 0);
+    set_function(f, 8, width - 8, true);
+
+    // Version information
+    if (version >= 7) {
+        uint32_t bits = version_bits(version);
+        for (int i = 0; i < 18; i++) {
+            bool bit = (bits >> i) & 1;
+            int a = width - 11 + i % 3;
+            int b = i / 3;
+            set_function(f, a, b, bit);
+            set_function(f, b, a, bit);
+        }
+    }
+}
+
+// Zigzag order of the data modules, skipping function modules
+void build_placement(Template& t) {
+    int width = t.width;
+    t.placement.reserve(raw_data_modules((width - 17) / 4));
+    for (int right = width - 1; right >= 1; right -= 2) {
+        if (right == 6) right = 5;
+        bool upward = ((right + 1) & 2) == 0;
+        for (int vert = 0; vert < width; vert++) {
+            int y = upward ? width - 1 - vert : vert;
+            for (int j = 0; j < 2; j++) {
+                int x = right - j;
+                if (get_bit(t.function, x, y)) continue;
+                t.placement.push_back(static_cast<uint16_t>((y * ROW_WORDS + (x >> 6)) * 64 + (x & 63)));
+            }
+        }
+    }
+}
+
+const Template* build_template(int version) {
+    std::unique_ptr<Template> t(new Template());
+    t->width = 17 + 4 * version;
+    std::fill(&t->dark[0][0], &t->dark[0][0] + MAX_WIDTH * ROW_WORDS, 0);
+    std::fill(&t->function[0][0], &t->function[0][0] + MAX_WIDTH * ROW_WORDS, 0);
+    draw_function_patterns(*t, version);
+    build_placement(*t);
+    return t.release();
+}
+
+// Per-version templates, built on first use and never modified or freed
+// afterwards, so every thread reads them without locking. Two threads
+// racing on a version both build it; one copy is kept.
+const Template& version_template(int version) {
+    static std::atomic<const Template*> cache[MAX_VERSION + 1];
+    const Template* t = cache[version].load(std::memory_order_acquire);
+    if (t == nullptr) {
+        const Template* fresh = build_template(version);
+        if (cache[version].compare_exchange_strong(t, fresh, std::memory_order_acq_rel)) {
+            t = fresh;
+        } else {
+            delete fresh;
+        }
+    }
+    return *t;
+}
+
+// Codeword bits onto the template's data modules (which `dark` has light);
+// remainder bits past the last codeword stay light
+void place_codewords(const Template& t, const std::vector<uint8_t>& codewords, Rows& dark) {
+    uint64_t* words = &dark[0][0];
+    const uint16_t* pos = t.placement.data();
+    for (uint8_t cw : codewords) {
+        for (int b = 7; b >= 0; b--, pos++) {
+            words[*pos >> 6] |= static_cast<uint64_t>((cw >> b) & 1) << (*pos & 63);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Masks and penalty scoring
+
+bool mask_condition(int mask, int x, int y) {
+    switch (mask) {
+        case 0: return (x + y) % 2 == 0;
+        case 1: return y % 2 == 0;
+        case 2: return x % 3 == 0;
+        case 3: return (x + y) % 3 == 0;
+        case 4: return (x / 3 + y / 2) % 2 == 0;
+        case 5: return x * y % 2 + x * y % 3 == 0;
+        case 6: return (x * y % 2 + x * y % 3) % 2 == 0;
+        default: return ((x + y) % 2 + x * y % 3) % 2 == 0;
+    }
+}
+
+// The eight mask patterns over the largest symbol, packed like the templates.
+// Built once, read-only afterwards.
+struct MaskTable {
+    Rows rows[8];
+
+    MaskTable() {
+        for (int m = 0; m < 8; m++) {
+            for (int y = 0; y < MAX_WIDTH; y++) {
+                for (int w = 0; w < ROW_WORDS; w++) rows[m][y][w] = 0;
+                for (int x = 0; x < MAX_WIDTH; x++) {
+                    if (mask_condition(m, x, y)) put_bit(rows[m], x, y, true);
+                }
+            }
+        }
+    }
+};
+
+const MaskTable& mask_table() {
+    static const MaskTable table;
+    return table;
+}
+
+// Penalty weights (ISO/IEC 18004 section 8.8.2)
+const int N1 = 3;
+const int N2 = 3;
+const int N3 = 40;
+const int N4 = 10;
+
+// N3 (1:1:3:1:1 finder-like) over one line's run lengths. runs[0] is a
+// light run, or -1 when the line starts dark, so odd indexes are dark runs.
+// Mirrors the N3 part of libqrencode's Mask_calcN1N3().
+int penalty_n3(const int* runs, int length) {
+    int demerit = 0;
+    for (int i = 3; i < length - 2; i += 2) {
+        if (runs[i] % 3 != 0) continue;
+        int fact = runs[i] / 3;
+        if (runs[i - 2] == fact && runs[i - 1] == fact && runs[i + 1] == fact && runs[i + 2] == fact) {
+            if (i == 3 || runs[i - 3] >= 4 * fact) {
+                demerit += N3;
+            } else if (i + 4 >= length || runs[i + 3] >= 4 * fact) {
+                demerit += N3;
+            }
+        }
+    }
+    return demerit;
+}
+
+// Bits of the last word of a line that lie inside the symbol
+inline uint64_t tail_mask(int width) {
+    return (width & 63) ? (uint64_t(1) << (width & 63)) - 1 : ~uint64_t(0);
+}
+
+// Bits of a multi-word line moved n places up (module x-n lands on x)
+inline uint64_t shifted(const uint64_t* line, int w, int n) {
+    return (line[w] << n) | (w ? line[w - 1] >> (64 - n) : 0);
+}
+
+// N1 on one packed line: a run of L >= 5 modules scores N1 + (L - 5).
+// Bit x of `window` is set when modules x-4..x share one color, so such a
+// run sets L - 4 window bits, the first of them after a clear one.
+int penalty_n1(const uint64_t* line, int width) {
+    int words = (width + 63) / 64;
+    uint64_t same[ROW_WORDS];
+    uint64_t window[ROW_WORDS];
+    int demerit = 0;
+    for (int w = 0; w < words; w++) {
+        same[w] = ~(line[w] ^ shifted(line, w, 1));
+        window[w] = same[w] & shifted(same, w, 1) & shifted(same, w, 2) & shifted(same, w, 3);
+        if (w == 0) window[w] &= ~uint64_t(0xF);
+        if (w == words - 1) window[w] &= tail_mask(width);
+        uint64_t starts = window[w] & ~shifted(window, w, 1);
+        demerit += __builtin_popcountll(window[w]) + (N1 - 1) * __builtin_popcountll(starts);
+    }
+    return demerit;
+}
+
+// Run lengths of one packed line in the layout penalty_n3() expects.
+// Run boundaries are the set bits of line ^ (line << 1), so the cost is
+// per run rather than per module.
+int line_runs(const uint64_t* line, int width, int* runs) {
+    int words = (width + 63) / 64;
+    int head = 0;
+    if (line[0] & 1) runs[head++] = -1;
+
+    int start = 0;
+    uint64_t carry = line[0] & 1;  // Module 0 never starts a new run
+    for (int w = 0; w < words; w++) {
+        uint64_t cur = line[w];
+        uint64_t edges = cur ^ ((cur << 1) | carry);
+        if (w == words - 1) edges &= tail_mask(width);
+        carry = cur >> 63;
+        while (edges) {
+            int x = w * 64 + __builtin_ctzll(edges);
+            runs[head++] = x - start;
+            start = x;
+            edges &= edges - 1;
+        }
+    }
+    runs[head++] = width - start;
+    return head;
+}
+
+// In-place transpose of a 64x64 bit block (bit x of word y <-> bit y of word x)
+void transpose64(uint64_t* a) {
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+// Column-major copy of the symbol: bit y of columns[x] = module (x, y)
+void transpose(const Rows& m, int width, Rows& columns) {
+    int words = (width + 63) / 64;
+    uint64_t block[64];
+    for (int by = 0; by < words; by++) {
+        for (int bx = 0; bx < words; bx++) {
+            for (int k = 0; k < 64; k++) {
+                int y = by * 64 + k;
+                block[k] = y < width ? m[y][bx] : 0;
+            }
+            transpose64(block);
+            for (int k = 0; k < 64 && bx * 64 + k < width; k++) {
+                columns[bx * 64 + k][by] = block[k];
+            }
+        }
+    }
+}
+
+// Penalty score of a masked symbol, evaluated on 64-bit words: popcounts
+// for N4, word-wide compares for N1 and N2, and edge bits for the N3 runs
+// (columns via a bit transpose). Same score as libqrencode's byte-per-module
+// Mask_evaluateSymbol(). Without finder_rule, N3 (the only rule that needs
+// run lengths) is skipped.
+int evaluate(const Rows& m, int width, bool finder_rule) {
+    int demerit = 0;
+    int words = (width + 63) / 64;
+    uint64_t last = tail_mask(width);
+
+    // N4: proportion of dark modules
+    int dark = 0;
+    for (int y = 0; y < width; y++) {
+        for (int w = 0; w < words; w++) {
+            dark += __builtin_popcountll(m[y][w]);
+        }
+    }
+    int total = width * width;
+    int ratio = (200 * dark + total) / total / 2;
+    demerit += std::abs(ratio - 50) / 5 * N4;
+
+    // N2: 2x2 blocks of one color. Bit x of `same` is set when modules x-1
+    // and x match in both rows and the two rows match at x.
+    int blocks = 0;
+    for (int y = 1; y < width; y++) {
+        const uint64_t* above = m[y - 1];
+        const uint64_t* row = m[y];
+        uint64_t vcarry = 0, hcarry = 0;
+        for (int w = 0; w < words; w++) {
+            uint64_t vertical = ~(above[w] ^ row[w]);
+            uint64_t horizontal = ~(row[w] ^ ((row[w] << 1) | hcarry));
+            uint64_t same = vertical & ((vertical << 1) | vcarry) & horizontal;
+            if (w == 0) same &= ~uint64_t(1);
+            if (w == words - 1) same &= last;
+            blocks += __builtin_popcountll(same);
+            vcarry = vertical >> 63;
+            hcarry = row[w] >> 63;
+        }
+    }
+    demerit += blocks * N2;
+
+    // N1 and N3 over rows and columns
+    Rows columns;
+    transpose(m, width, columns);
+    int runs[MAX_WIDTH + 1];
+    for (int i = 0; i < width; i++) {
+        demerit += penalty_n1(m[i], width) + penalty_n1(columns[i], width);
+        if (finder_rule) {
+            demerit += penalty_n3(runs, line_runs(m[i], width, runs));
+            demerit += penalty_n3(runs, line_runs(columns[i], width, runs));
+        }
+    }
+
+    return demerit;
+}
+
+void apply_mask(const Template& t, const Rows& symbol, int mask, int level, Rows& out) {
+    const Rows& pattern = mask_table().rows[mask];
+    int words = (t.width + 63) / 64;
+    for (int y = 0; y < t.width; y++) {
+        for (int w = 0; w < words; w++) {
+            out[y][w] = symbol[y][w] ^ (pattern[y][w] & ~t.function[y][w]);
+        }
+        // Clear bits past the symbol edge
+        if (t.width & 63) {
+            out[y][words - 1] &= (uint64_t(1) << (t.width & 63)) - 1;
+        }
+    }
+    draw_format(out, nullptr, t.width, format_bits(level, mask));
+}
+
+bool encode_segments(const std::vector<Segment>& segments, int version, int level, int mask, Matrix& out) {
+    int data_codewords = CAPACITY.data_codewords[level][version];
+
+    BitBuffer bb(data_codewords);
+    write_segments(segments, version, bb);
+    if (bb.bits() > data_codewords * 8) {
+        return false;  // Does not fit in version 40
+    }
+    append_padding(bb, data_codewords);
+
+    std::vector<uint8_t> codewords = add_ecc_and_interleave(bb.bytes(), version, level);
+
+    // Unmasked symbol: the version's function patterns plus the codewords
+    const Template& tpl = version_template(version);
+    int width = tpl.width;
+    std::unique_ptr<Rows[]> buffers(new Rows[3]);
+    Rows& symbol = buffers[0];
+    std::copy(&tpl.dark[0][0], &tpl.dark[0][0] + width * ROW_WORDS, &symbol[0][0]);
+    place_codewords(tpl, codewords, symbol);
+
+    Rows& best = buffers[1];
+    Rows& trial = buffers[2];
+    int best_mask = 0;
+    if (mask >= 0 && mask < 8) {
+        // Caller's choice, no penalty evaluation
+        best_mask = mask;
+        apply_mask(tpl, symbol, mask, level, best);
+    } else {
+        // Try all eight masks; lowest penalty wins, first one on ties
+        bool finder_rule = mask != QROptions::MASK_FAST;
+        int best_demerit = INT_MAX;
+        for (int m = 0; m < 8; m++) {
+            apply_mask(tpl, symbol, m, level, trial);
+            int demerit = evaluate(trial, width, finder_rule);
+            if (demerit < best_demerit) {
+                best_demerit = demerit;
+                best_mask = m;
+                std::copy(&trial[0][0], &trial[0][0] + MAX_WIDTH * ROW_WORDS, &best[0][0]);
+            }
+        }
+    }
+
+    out.version = version;
+    out.width = width;
+    out.mask = best_mask;
+    out.modules.resize(static_cast<size_t>(width) * width);
+    for (int y = 0; y < width; y++) {
+        for (int x = 0; x < width; x++) {
+            out.modules[y * width + x] = get_bit(best, x, y) ? 1 : 0;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool encode(const std::string& data, const QROptions& options, Matrix& out) {
+    int level = static_cast<int>(options.ec_level);
+    if (level < 0 || level > 3) level = 1;
+
+    bool optimal = options.segmentation == QROptions::SEGMENT_OPTIMAL;
+    std::vector<uint8_t> modes(optimal ? data.size() : 0);
+    TextClass text = classify_text(data.data(), data.size(), optimal ? modes.data() : nullptr);
+
+    std::vector<Segment> segments;
+    int version;
+    if (optimal && text.numeric && !data.empty()) {
+        // One numeric segment is optimal, no need for the search
+        segments.push_back({MODE_NUM, data.data(), static_cast<int>(data.size())});
+        version = select_version(segments, level);
+    } else if (optimal && text.kanji) {
+        version = optimal_version(data.data(), modes.data(), data.size(), level, segments);
+    } else {
+        if (!optimal && text.ascii) {
+            // Mixed numeric/alphanumeric/8-bit segments. Stops at the first
+            // NUL, as QRcode_encodeString() does with a C string.
+            Splitter(segments).split(data.c_str());
+        } else {
+            // UTF-8 (or binary) data as one 8-bit segment
+            segments.push_back({MODE_8, data.data(), static_cast<int>(data.size())});
+        }
+        version = select_version(segments, level);
+    }
+
+    return encode_segments(segments, version, level, options.mask, out);
+}
+
+} // namespace qr
+} // namespace fastqr
@@ -0,0 +1,65 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_QR_ENCODER_H
+#define FASTQR_QR_ENCODER_H
+
+// Built-in QR Code model 2 encoder (ISO/IEC 18004).
+//
+// By default the data is split into numeric, alphanumeric, 8-bit and Kanji
+// segments that give the shortest bit stream. With
+// QROptions::SEGMENT_COMPAT it produces the same symbols as the libqrencode
+// calls fastqr used before: QRcode_encodeString(data, 0, level, QR_MODE_8, 1)
+// for ASCII input and QRcode_encodeData() for everything else - same
+// segmentation, version, mask choice and module layout.
+
+#include "fastqr.h"
+#include <string>
+#include <vector>
+
+namespace fastqr {
+namespace qr {
+
+// Module matrix: width x width bytes, row-major, bit 0 set = dark module
+// (same layout as libqrencode's QRcode::data)
+struct Matrix {
+    int version = 0;
+    int width = 0;
+    int mask = -1;
+    std::vector<unsigned char> modules;
+};
+
+/**
+ * Encode text into a QR module matrix
+ *
+ * Thread-safe: per-version templates and generator tables are built on
+ * first use and only read afterwards.
+ *
+ * @param data The data to encode (UTF-8; Shift JIS characters may use Kanji mode)
+ * @param options Only ec_level, mask and segmentation are used
+ * @param out Receives the matrix
+ * @return true if successful, false if the data does not fit in version 40
+ */
+bool encode(const std::string& data, const QROptions& options, Matrix& out);
+
+} // namespace qr
+} // namespace fastqr
+
+#endif // FASTQR_QR_ENCODER_H
@@ -0,0 +1,449 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_RASTER_H
+#define FASTQR_RASTER_H
+
+// Module matrix -> pixel rows, one template for every output format.
+//
+// render() is instantiated per pixel format (how a row is stored and how a
+// span of dark pixels is written) and per scale kind (which pixels each
+// module covers). Both are resolved at compile time, so each combination
+// gets its own inner loop without per-pixel branches. Rows start out as
+// background and only runs of dark pixels are written, one fill per run;
+// an output row whose source row is the same as the previous one is copied
+// whole. A new format only needs a new format struct (plus blend() for
+// area-weighted scaling).
+
+#include "fastqr_internal.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace fastqr {
+namespace detail {
+
+// ---------------------------------------------------------------------------
+// Pixel formats
+
+// Mix of background and foreground for a pixel `coverage`/255 dark, rounded.
+// Fits in 16 bits throughout, so loops over rows vectorize to 16-bit lanes.
+inline unsigned char blend_value(unsigned bg, unsigned fg, unsigned coverage) {
+    uint16_t t = static_cast<uint16_t>(bg * (255 - coverage) + fg * coverage + 128);
+    return static_cast<unsigned char>((t + (t >> 8)) >> 8);
+}
+
+// 1 bit per pixel, MSB first, 1 = dark (indexed PNG with a black/white palette)
+struct Packed1Format {
+    static const PixelFormat FORMAT = PixelFormat::INDEXED_1BIT;
+
+    static size_t row_bytes(int width) { return (static_cast<size_t>(width) + 7) / 8; }
+
+    void fill_background(unsigned char* row, int width) const { std::memset(row, 0, row_bytes(width)); }
+
+    void fill_dark(unsigned char* row, int x, int count) const {
+        int end = x + count;
+        unsigned char* first = row + (x >> 3);
+        unsigned char* last = row + ((end - 1) >> 3);
+        unsigned char head = static_cast<unsigned char>(0xFF >> (x & 7));
+        unsigned char tail = static_cast<unsigned char>(0xFF << (7 - ((end - 1) & 7)));
+        if (first == last) {
+            *first |= head & tail;
+            return;
+        }
+        *first |= head;
+        std::memset(first + 1, 0xFF, last - first - 1);
+        *last |= tail;
+    }
+};
+
+// 8-bit gray
+struct Gray8Format {
+    static const PixelFormat FORMAT = PixelFormat::GRAY8;
+    unsigned char fg;
+    unsigned char bg;
+
+    static size_t row_bytes(int width) { return static_cast<size_t>(width); }
+
+    void fill_background(unsigned char* row, int width) const { std::memset(row, bg, width); }
+
+    void fill_dark(unsigned char* row, int x, int count) const { std::memset(row + x, fg, count); }
+
+    // Pixels x to x + count - 1 from their dark coverage (0-255)
+    void blend(unsigned char* row, int x, const unsigned char* coverage, int count) const {
+        unsigned char* p = row + x;
+        for (int i = 0; i < count; i++) p[i] = blend_value(bg, fg, coverage[i]);
+    }
+};
+
+// 24-bit RGB. Colors are kept as 48-byte blocks (16 pixels, a whole
+// number of both 3-byte pixels and 16-byte vectors), so long runs are
+// filled with plain vector copies and only the last few pixels one by one.
+struct Rgb8Format {
+    static const PixelFormat FORMAT = PixelFormat::RGB8;
+    static const int BLOCK_PIXELS = 16;
+    unsigned char fg[BLOCK_PIXELS * 3];
+    unsigned char bg[BLOCK_PIXELS * 3];
+
+    Rgb8Format(const QROptions::Color& foreground, const QROptions::Color& background) {
+        for (int i = 0; i < BLOCK_PIXELS; i++) {
+            fg[i * 3] = foreground.r;
+            fg[i * 3 + 1] = foreground.g;
+            fg[i * 3 + 2] = foreground.b;
+            bg[i * 3] = background.r;
+            bg[i * 3 + 1] = background.g;
+            bg[i * 3 + 2] = background.b;
+        }
+    }
+
+    static size_t row_bytes(int width) { return static_cast<size_t>(width) * 3; }
+
+    static void fill_color(unsigned char* p, int count, const unsigned char* block) {
+        for (; count >= BLOCK_PIXELS; count -= BLOCK_PIXELS, p += BLOCK_PIXELS * 3) {
+            std::memcpy(p, block, BLOCK_PIXELS * 3);
+        }
+        std::memcpy(p, block, count * 3);
+    }
+
+    void fill_background(unsigned char* row, int width) const { fill_color(row, width, bg); }
+
+    void fill_dark(unsigned char* row, int x, int count) const { fill_color(row + x * 3, count, fg); }
+
+    // Pixels x to x + count - 1 from their dark coverage (0-255); the three
+    // channels of a pixel share one coverage value
+    void blend(unsigned char* row, int x, const unsigned char* coverage, int count) const {
+        unsigned char* p = row + x * 3;
+        for (int i = 0; i < count; i++, p += 3) {
+            unsigned c = coverage[i];
+            p[0] = blend_value(bg[0], fg[0], c);
+            p[1] = blend_value(bg[1], fg[1], c);
+            p[2] = blend_value(bg[2], fg[2], c);
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Packed rows at integer scale: whole words instead of single bits
+
+// Writes a 1-bit row MSB first, 64 bits per store
+class BitRowWriter {
+public:
+    explicit BitRowWriter(unsigned char* row) : out_(row) {}
+
+    // Append the low `count` bits of `bits` (1 to 64), most significant first
+    void put(uint64_t bits, int count) {
+        int room = 64 - used_;
+        if (count < room) {
+            acc_ |= bits << (room - count);
+            used_ += count;
+            return;
+        }
+        int rest = count - room;
+        acc_ |= bits >> rest;
+        store_word();
+        acc_ = rest ? bits << (64 - rest) : 0;
+        used_ = rest;
+    }
+
+    // Append `count` copies of one bit
+    void put_run(bool dark, int count) {
+        for (; count > 64; count -= 64) put(dark ? ~0ULL : 0, 64);
+        if (count > 0) put(dark ? ~0ULL >> (64 - count) : 0, count);
+    }
+
+    // Write out the last partial word
+    void flush() {
+        for (int i = 0; i < (used_ + 7) / 8; i++) {
+            *out_++ = static_cast<unsigned char>(acc_ >> (56 - 8 * i));
+        }
+    }
+
+private:
+    void store_word() {
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t word = __builtin_bswap64(acc_);
+        std::memcpy(out_, &word, 8);
+        out_ += 8;
+#else
+        used_ = 64;
+        flush();
+#endif
+    }
+
+    unsigned char* out_;
+    uint64_t acc_ = 0;
+    int used_ = 0;
+};
+
+const int MAX_LUT_SCALE = 8;
+
+// expand[scale - 1][b]: the 8 bits of b (MSB first) each repeated `scale`
+// times, i.e. 8 modules -> 8 * scale pixels in one lookup
+struct PackedExpandTable {
+    uint64_t expand[MAX_LUT_SCALE][256];
+
+    PackedExpandTable() {
+        for (int scale = 1; scale <= MAX_LUT_SCALE; scale++) {
+            uint64_t run = (1ULL << scale) - 1;
+            for (int b = 0; b < 256; b++) {
+                uint64_t bits = 0;
+                for (int j = 0; j < 8; j++) {
+                    if (b & (1 << j)) bits |= run << (j * scale);
+                }
+                expand[scale - 1][b] = bits;
+            }
+        }
+    }
+};
+
+inline const PackedExpandTable& packed_expand_table() {
+    static const PackedExpandTable table;
+    return table;
+}
+
+// One packed row: `margin` light pixels, then each module `scale` pixels
+inline void expand_packed_row(const unsigned char* modules, int qr_size, int scale, int margin, unsigned char* row) {
+    BitRowWriter writer(row);
+    if (margin > 0) writer.put_run(false, margin);
+
+    int m = 0;
+    if (scale <= MAX_LUT_SCALE) {
+        const uint64_t* expand = packed_expand_table().expand[scale - 1];
+        for (; m + 8 <= qr_size; m += 8) {
+            unsigned b = 0;
+            for (int j = 0; j < 8; j++) b = (b << 1) | (modules[m + j] & 1);
+            writer.put(expand[b], 8 * scale);
+        }
+    }
+    for (; m < qr_size; m++) {
+        writer.put_run(modules[m] & 1, scale);
+    }
+    writer.flush();
+}
+
+// ---------------------------------------------------------------------------
+// Scale kinds: which source row an output row shows (y relative to the
+// margin; consecutive rows with the same source are copies) and how that
+// row's modules are drawn over a background row
+
+// Every module is `scale` whole pixels
+struct IntegerScale {
+    int scale;
+
+    int source_row(int y) const { return y / scale; }
+
+    template <class Format>
+    void build_row(const Format& format, const QRMatrix& qr, int y, unsigned char* row, int margin) const {
+        const int qr_size = qr.width;
+        const unsigned char* modules = qr.modules.data() + static_cast<size_t>(source_row(y)) * qr_size;
+        for (int m = 0; m < qr_size;) {
+            if (!(modules[m] & 1)) {
+                m++;
+                continue;
+            }
+            int end = m + 1;
+            while (end < qr_size && (modules[end] & 1)) end++;
+            format.fill_dark(row, margin + m * scale, (end - m) * scale);
+            m = end;
+        }
+    }
+
+    void build_row(const Packed1Format&, const QRMatrix& qr, int y, unsigned char* row, int margin) const {
+        const unsigned char* modules = qr.modules.data() + static_cast<size_t>(source_row(y)) * qr.width;
+        expand_packed_row(modules, qr.width, scale, margin, row);
+    }
+};
+
+// Nearest neighbour: output pixel x shows module x * qr_size / inner_size.
+// The mapping is worked out once per image, as the module shown by each
+// output column (and row) and the span of columns each module covers, so
+// rows are filled from runs of modules as at integer scale.
+struct FractionalScale {
+    std::vector<int> source;  // Module shown by output pixel x (or row y)
+    std::vector<int> start;   // Module m covers pixels start[m] to start[m + 1] - 1
+
+    FractionalScale(int qr_size, int inner_size) : source(inner_size), start(qr_size + 1) {
+        double ratio = static_cast<double>(qr_size) / inner_size;
+        int m = 0;
+        for (int x = 0; x < inner_size; x++) {
+            source[x] = static_cast<int>(x * ratio);
+            while (m <= source[x]) start[m++] = x;
+        }
+        while (m <= qr_size) start[m++] = inner_size;
+    }
+
+    int source_row(int y) const { return source[y]; }
+
+    template <class Format>
+    void build_row(const Format& format, const QRMatrix& qr, int y, unsigned char* row, int margin) const {
+        const int qr_size = qr.width;
+        const unsigned char* modules = qr.modules.data() + static_cast<size_t>(source[y]) * qr_size;
+        for (int m = 0; m < qr_size;) {
+            if (!(modules[m] & 1)) {
+                m++;
+                continue;
+            }
+            int end = m + 1;
+            while (end < qr_size && (modules[end] & 1)) end++;
+            format.fill_dark(row, margin + start[m], start[end] - start[m]);
+            m = end;
+        }
+    }
+};
+
+// Area-weighted (box filter): every pixel is the share of its square that
+// dark modules cover. Modules are at least a pixel wide, so a pixel holds
+// at most one module edge. Where each module edge falls, and how much of
+// that pixel lies before it, is worked out once per image; a row is
+// then its modules' coverage (whole pixels as runs, one weighted pixel per
+// edge) blended into the colors in one pass. The same table serves rows:
+// an output row straddling two module rows mixes their coverage.
+struct AreaScale {
+    std::vector<int> begin;            // Pixels begin[m] to end[m] - 1 lie wholly in module m
+    std::vector<int> end;
+    std::vector<unsigned char> edge;   // Share (0-255) of pixel end[m] in module m when it straddles m and m + 1
+    std::vector<int> module;           // Module row under output row y (the upper one when straddling)
+    std::vector<unsigned char> weight; // Share (0-255) of output row y in that module row
+    mutable std::vector<unsigned char> coverage;  // Scratch rows; one AreaScale per render() call
+    mutable std::vector<unsigned char> lower;
+
+    AreaScale(int qr_size, int inner_size)
+        : begin(qr_size), end(qr_size), edge(qr_size, 255), module(inner_size), weight(inner_size, 255),
+          coverage(inner_size), lower(inner_size) {
+        // Module m spans [m * inner_size, (m + 1) * inner_size) in units of 1/qr_size pixel
+        for (int m = 0; m < qr_size; m++) {
+            int64_t left = static_cast<int64_t>(m) * inner_size;
+            int64_t right = left + inner_size;
+            begin[m] = static_cast<int>((left + qr_size - 1) / qr_size);
+            end[m] = static_cast<int>(right / qr_size);
+            int64_t cut = right - static_cast<int64_t>(end[m]) * qr_size;
+            if (cut > 0) edge[m] = static_cast<unsigned char>((cut * 255 + qr_size / 2) / qr_size);
+            for (int y = begin[m]; y < end[m]; y++) module[y] = m;
+            if (cut > 0) {
+                module[end[m]] = m;
+                weight[end[m]] = edge[m];
+            }
+        }
+    }
+
+    // Rows straddling two module rows get a key of their own past the last
+    // module row, so they are never taken as a copy of their neighbour
+    int source_row(int y) const { return weight[y] == 255 ? module[y] : static_cast<int>(begin.size()) + y; }
+
+    template <class Format>
+    void build_row(const Format& format, const QRMatrix& qr, int y, unsigned char* row, int margin) const {
+        const int qr_size = qr.width;
+        const int inner_size = static_cast<int>(coverage.size());
+        const unsigned char* modules = qr.modules.data() + static_cast<size_t>(module[y]) * qr_size;
+        unsigned char* upper = coverage.data();
+        row_coverage(modules, qr_size, upper);
+        if (weight[y] != 255) {
+            const unsigned char* below = lower.data();
+            row_coverage(modules + qr_size, qr_size, lower.data());
+            unsigned w = weight[y];
+            for (int x = 0; x < inner_size; x++) upper[x] = blend_value(below[x], upper[x], w);
+        }
+        format.blend(row, margin, upper, inner_size);
+    }
+
+private:
+    // Dark share of every pixel under one module row: light, then each run
+    // of dark modules filled whole, with partial pixels only at its two ends
+    void row_coverage(const unsigned char* modules, int qr_size, unsigned char* out) const {
+        std::memset(out, 0, end[qr_size - 1]);
+        for (int m = 0; m < qr_size;) {
+            if (!(modules[m] & 1)) {
+                m++;
+                continue;
+            }
+            int last = m;
+            while (last + 1 < qr_size && (modules[last + 1] & 1)) last++;
+            std::memset(out + begin[m], 255, end[last] - begin[m]);
+            if (m > 0 && end[m - 1] < begin[m]) out[end[m - 1]] = static_cast<unsigned char>(255 - edge[m - 1]);
+            if (last + 1 < qr_size && end[last] < begin[last + 1]) out[end[last]] = edge[last];
+            m = last + 1;
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * Render a module matrix into a size x size image
+ *
+ * @param format Pixel format (and colors)
+ * @param scale Module to pixel mapping of the inner area
+ * @param qr Module matrix
+ * @param size Image width and height in pixels
+ * @param margin Quiet zone in pixels on every side (inner area is size - 2 * margin)
+ * @param pixels Receives the rows, Format::row_bytes(size) bytes each
+ */
+template <class Format, class Scale>
+void render(const Format& format, const Scale& scale, const QRMatrix& qr, int size, int margin,
+            std::vector<unsigned char>& pixels) {
+    const size_t row_bytes = Format::row_bytes(size);
+    const int inner_size = size - 2 * margin;
+    pixels.resize(row_bytes * size);
+
+    std::vector<unsigned char> background(row_bytes);
+    format.fill_background(background.data(), size);
+
+    unsigned char* out = pixels.data();
+    for (int y = 0; y < margin; y++) {
+        std::memcpy(out + y * row_bytes, background.data(), row_bytes);
+    }
+
+    int previous = -1;
+    for (int y = 0; y < inner_size; y++) {
+        unsigned char* row = out + (margin + y) * row_bytes;
+        int source = scale.source_row(y);
+        if (source == previous) {
+            std::memcpy(row, row - row_bytes, row_bytes);
+            continue;
+        }
+        previous = source;
+        std::memcpy(row, background.data(), row_bytes);
+        scale.build_row(format, qr, y, row, margin);
+    }
+
+    for (int y = margin + inner_size; y < size; y++) {
+        std::memcpy(out + y * row_bytes, background.data(), row_bytes);
+    }
+}
+
+// render() with the scale kind that fits: integer when the inner area is a
+// whole multiple of the QR width, otherwise as `scaling` asks
+template <class Format>
+void render_scaled(const Format& format, QROptions::Scaling scaling, const QRMatrix& qr, int size, int margin,
+                   std::vector<unsigned char>& pixels) {
+    int inner_size = size - 2 * margin;
+    if (inner_size % qr.width == 0) {
+        render(format, IntegerScale{inner_size / qr.width}, qr, size, margin, pixels);
+    } else if (scaling == QROptions::SCALE_AREA) {
+        render(format, AreaScale(qr.width, inner_size), qr, size, margin, pixels);
+    } else {
+        render(format, FractionalScale(qr.width, inner_size), qr, size, margin, pixels);
+    }
+}
+
+} // namespace detail
+} // namespace fastqr
+
+#endif // FASTQR_RASTER_H
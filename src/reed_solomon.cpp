@@ -0,0 +1,241 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#include "reed_solomon.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace fastqr {
+namespace qr {
+namespace {
+
+// ---------------------------------------------------------------------------
+// GF(256) arithmetic, primitive polynomial x^8 + x^4 + x^3 + x^2 + 1
+
+struct GaloisTables {
+    uint8_t exp[512];
+    uint8_t log[256];
+};
+
+constexpr GaloisTables build_galois_tables() {
+    GaloisTables t{};
+    int x = 1;
+    for (int i = 0; i < 255; i++) {
+        t.exp[i] = static_cast<uint8_t>(x);
+        t.exp[i + 255] = static_cast<uint8_t>(x);
+        t.log[x] = static_cast<uint8_t>(i);
+        x <<= 1;
+        if (x & 0x100) x ^= 0x11D;
+    }
+    t.exp[510] = t.exp[0];
+    t.exp[511] = t.exp[1];
+    return t;
+}
+
+constexpr GaloisTables GF = build_galois_tables();
+
+inline uint8_t gf_mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) return 0;
+    return GF.exp[GF.log[a] + GF.log[b]];
+}
+
+void build_generator(int degree, RsGenerator& gen) {
+    gen.degree = degree;
+    uint8_t* out = gen.coef;
+    std::fill(out, out + degree, 0);
+    out[degree - 1] = 1;
+    uint8_t root = 1;
+    for (int i = 0; i < degree; i++) {
+        for (int j = 0; j < degree; j++) {
+            out[j] = gf_mul(out[j], root);
+            if (j + 1 < degree) out[j] ^= out[j + 1];
+        }
+        root = gf_mul(root, 0x02);
+    }
+
+    for (int j = 0; j < degree; j++) {
+        for (int x = 0; x < 16; x++) {
+            gen.mul_lo[j][x] = gen.row_lo[x][j] = gf_mul(out[j], static_cast<uint8_t>(x));
+            gen.mul_hi[j][x] = gen.row_hi[x][j] = gf_mul(out[j], static_cast<uint8_t>(x << 4));
+        }
+    }
+}
+
+struct GeneratorTable {
+    RsGenerator by_degree[RS_MAX_DEGREE + 1];
+
+    GeneratorTable() {
+        for (int d = 1; d <= RS_MAX_DEGREE; d++) {
+            build_generator(d, by_degree[d]);
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// One block at a time: the remainder register shifts by one codeword per
+// data codeword and the feedback's two table rows are XORed in (the loop
+// over the register vectorizes)
+
+void encode_block(const RsGenerator& gen, const uint8_t* data, int length, uint8_t* out, int stride) {
+    const int degree = gen.degree;
+    uint8_t r[RS_MAX_DEGREE + 1] = {0};  // r[degree] stays 0
+    for (int i = 0; i < length; i++) {
+        uint8_t factor = data[i] ^ r[0];
+        const uint8_t* lo = gen.row_lo[factor & 0x0F];
+        const uint8_t* hi = gen.row_hi[factor >> 4];
+        for (int j = 0; j < degree; j++) {
+            r[j] = r[j + 1] ^ lo[j] ^ hi[j];
+        }
+    }
+    for (int j = 0; j < degree; j++) {
+        out[j * stride] = r[j];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Many blocks at once: lane b of every vector belongs to block b, and the
+// nibble tables become byte shuffles
+
+#if defined(__AVX2__)
+
+struct Simd {
+    using V = __m256i;
+    static const int LANES = 32;
+    static V load(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint8_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V zero() { return _mm256_setzero_si256(); }
+    // Same 16-entry table in both 128-bit halves (shuffles stay in a half)
+    static V table(const uint8_t* t) {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t)));
+    }
+    static V lookup(V table, V index) { return _mm256_shuffle_epi8(table, index); }
+    static V bit_xor(V a, V b) { return _mm256_xor_si256(a, b); }
+    static V low_nibble(V v) { return _mm256_and_si256(v, _mm256_set1_epi8(0x0F)); }
+    static V high_nibble(V v) { return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)); }
+};
+#define FASTQR_RS_SIMD 1
+
+#elif defined(__SSSE3__)
+
+struct Simd {
+    using V = __m128i;
+    static const int LANES = 16;
+    static V load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint8_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V zero() { return _mm_setzero_si128(); }
+    static V table(const uint8_t* t) { return load(t); }
+    static V lookup(V table, V index) { return _mm_shuffle_epi8(table, index); }
+    static V bit_xor(V a, V b) { return _mm_xor_si128(a, b); }
+    static V low_nibble(V v) { return _mm_and_si128(v, _mm_set1_epi8(0x0F)); }
+    static V high_nibble(V v) { return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)); }
+};
+#define FASTQR_RS_SIMD 1
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+struct Simd {
+    using V = uint8x16_t;
+    static const int LANES = 16;
+    static V load(const uint8_t* p) { return vld1q_u8(p); }
+    static void store(uint8_t* p, V v) { vst1q_u8(p, v); }
+    static V zero() { return vdupq_n_u8(0); }
+    static V table(const uint8_t* t) { return vld1q_u8(t); }
+    static V lookup(V table, V index) { return vqtbl1q_u8(table, index); }
+    static V bit_xor(V a, V b) { return veorq_u8(a, b); }
+    static V low_nibble(V v) { return vandq_u8(v, vdupq_n_u8(0x0F)); }
+    static V high_nibble(V v) { return vshrq_n_u8(v, 4); }
+};
+#define FASTQR_RS_SIMD 1
+
+#endif
+
+#ifdef FASTQR_RS_SIMD
+// Up to Simd::LANES blocks starting at `data`, `lanes` of them real
+void encode_lanes(const RsGenerator& gen, const uint8_t* data, int length, int lanes, uint8_t* out,
+                  int stride) {
+    using V = Simd::V;
+    const int degree = gen.degree;
+
+    V lo_table[RS_MAX_DEGREE];
+    V hi_table[RS_MAX_DEGREE];
+    V r[RS_MAX_DEGREE];
+    for (int j = 0; j < degree; j++) {
+        lo_table[j] = Simd::table(gen.mul_lo[j]);
+        hi_table[j] = Simd::table(gen.mul_hi[j]);
+        r[j] = Simd::zero();
+    }
+
+    // Codeword i of every block, gathered into one vector (unused lanes 0)
+    alignas(32) uint8_t column[Simd::LANES] = {0};
+    for (int i = 0; i < length; i++) {
+        for (int b = 0; b < lanes; b++) {
+            column[b] = data[b * length + i];
+        }
+        V factor = Simd::bit_xor(Simd::load(column), r[0]);
+        V lo = Simd::low_nibble(factor);
+        V hi = Simd::high_nibble(factor);
+        for (int j = 0; j + 1 < degree; j++) {
+            r[j] = Simd::bit_xor(r[j + 1], Simd::bit_xor(Simd::lookup(lo_table[j], lo),
+                                                         Simd::lookup(hi_table[j], hi)));
+        }
+        r[degree - 1] = Simd::bit_xor(Simd::lookup(lo_table[degree - 1], lo),
+                                      Simd::lookup(hi_table[degree - 1], hi));
+    }
+
+    alignas(32) uint8_t row[Simd::LANES];
+    for (int j = 0; j < degree; j++) {
+        Simd::store(row, r[j]);
+        std::memcpy(out + j * stride, row, lanes);
+    }
+}
+#endif
+
+} // namespace
+
+const RsGenerator& rs_generator(int degree) {
+    static const GeneratorTable table;
+    return table.by_degree[degree];
+}
+
+void rs_encode_group(const RsGenerator& gen, const uint8_t* data, int length, int count, uint8_t* out,
+                     int stride) {
+    int b = 0;
+#ifdef FASTQR_RS_SIMD
+    // Single blocks (versions 1-5 and a few more) gain nothing from lanes
+    if (count > 1) {
+        for (; b < count; b += Simd::LANES) {
+            int lanes = count - b < Simd::LANES ? count - b : Simd::LANES;
+            encode_lanes(gen, data + b * length, length, lanes, out + b, stride);
+        }
+    }
+#endif
+    for (; b < count; b++) {
+        encode_block(gen, data + b * length, length, out + b, stride);
+    }
+}
+
+} // namespace qr
+} // namespace fastqr
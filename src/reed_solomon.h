@@ -0,0 +1,76 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_REED_SOLOMON_H
+#define FASTQR_REED_SOLOMON_H
+
+// Reed-Solomon error correction codewords over GF(256) (ISO/IEC 18004 7.5).
+//
+// Multiplication by each generator coefficient is a pair of 16-entry
+// nibble tables, so one step of the division is two table lookups per
+// coefficient. With AVX2 (32 lanes), SSSE3 or AArch64 NEON (16 lanes)
+// the lookups are byte shuffles and every lane carries its own block: a
+// group of blocks is divided in lockstep. The instruction set is picked
+// at compile time; without one of them the same tables are used a block
+// at a time.
+
+#include <cstdint>
+
+namespace fastqr {
+namespace qr {
+
+const int RS_MAX_DEGREE = 30;  // Most ECC codewords per block (Table 9)
+
+// Generator polynomial (x - a^0)(x - a^1)...(x - a^(degree-1)), leading 1
+// omitted, with the nibble multiplication tables of each coefficient
+struct RsGenerator {
+    int degree = 0;
+    uint8_t coef[RS_MAX_DEGREE];
+    uint8_t mul_lo[RS_MAX_DEGREE][16];  // coef[j] * x
+    uint8_t mul_hi[RS_MAX_DEGREE][16];  // coef[j] * (x << 4)
+    uint8_t row_lo[16][RS_MAX_DEGREE];  // Same products by row: x * every coef
+    uint8_t row_hi[16][RS_MAX_DEGREE];
+};
+
+/**
+ * Generator for `degree` ECC codewords (1 to RS_MAX_DEGREE)
+ *
+ * Built on first use and immutable afterwards: safe to share across threads.
+ */
+const RsGenerator& rs_generator(int degree);
+
+/**
+ * ECC codewords for a group of equal-length blocks
+ *
+ * @param gen Generator (its degree is the ECC length)
+ * @param data Data codewords, block after block (`count` blocks of `length`)
+ * @param length Data codewords per block
+ * @param count Number of blocks
+ * @param out ECC codeword j of block b is written to out[j * stride + b]
+ * @param stride Distance between consecutive codewords of one block
+ *               (the total block count writes them interleaved)
+ */
+void rs_encode_group(const RsGenerator& gen, const uint8_t* data, int length, int count, uint8_t* out,
+                     int stride);
+
+} // namespace qr
+} // namespace fastqr
+
+#endif // FASTQR_REED_SOLOMON_H
@@ -0,0 +1,458 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#include "serve.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Minimal JSON value: the protocol only uses flat objects of
+// strings, numbers, booleans and arrays of numbers
+struct JsonValue {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY } type = NUL;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<double> array;
+    std::string raw;  // Original JSON text (used to echo "id")
+};
+
+using JsonObject = std::map<std::string, JsonValue>;
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    bool parse_object(JsonObject& out, std::string& error) {
+        skip_ws();
+        if (!consume('{')) return fail(error, "expected '{'");
+        skip_ws();
+        if (consume('}')) return at_end(error);
+
+        for (;;) {
+            skip_ws();
+            std::string key;
+            if (!parse_string(key)) return fail(error, "expected string key");
+            skip_ws();
+            if (!consume(':')) return fail(error, "expected ':'");
+            skip_ws();
+            JsonValue value;
+            if (!parse_value(value)) return fail(error, "invalid value for \"" + key + "\"");
+            out[key] = std::move(value);
+            skip_ws();
+            if (consume(',')) continue;
+            if (consume('}')) return at_end(error);
+            return fail(error, "expected ',' or '}'");
+        }
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_ = 0;
+
+    static bool fail(std::string& error, const std::string& message) {
+        error = "Invalid JSON: " + message;
+        return false;
+    }
+
+    bool at_end(std::string& error) {
+        skip_ws();
+        return pos_ == text_.size() || fail(error, "trailing characters");
+    }
+
+    void skip_ws() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                       text_[pos_] == '\r' || text_[pos_] == '\n')) {
+            pos_++;
+        }
+    }
+
+    bool consume(char c) {
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume_word(const char* word) {
+        size_t len = std::strlen(word);
+        if (text_.compare(pos_, len, word) == 0) {
+            pos_ += len;
+            return true;
+        }
+        return false;
+    }
+
+    static void append_utf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool parse_hex4(unsigned& cp) {
+        if (pos_ + 4 > text_.size()) return false;
+        cp = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text_[pos_++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    bool parse_string(std::string& out) {
+        if (!consume('"')) return false;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) return false;
+            char e = text_[pos_++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned cp;
+                    if (!parse_hex4(cp)) return false;
+                    // Surrogate pair (e.g. emoji)
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        unsigned low;
+                        if (!consume('\\') || !consume('u') || !parse_hex4(low) ||
+                            low < 0xDC00 || low > 0xDFFF) {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool parse_number(double& out) {
+        const char* start = text_.c_str() + pos_;
+        char* end = nullptr;
+        out = std::strtod(start, &end);
+        if (end == start) return false;
+        pos_ += end - start;
+        return true;
+    }
+
+    bool parse_value(JsonValue& value) {
+        size_t start = pos_;
+        bool ok;
+        if (pos_ >= text_.size()) return false;
+
+        char c = text_[pos_];
+        if (c == '"') {
+            value.type = JsonValue::STRING;
+            ok = parse_string(value.string);
+        } else if (c == '[') {
+            value.type = JsonValue::ARRAY;
+            pos_++;
+            skip_ws();
+            ok = consume(']');
+            while (!ok) {
+                skip_ws();
+                double number;
+                if (!parse_number(number)) return false;
+                value.array.push_back(number);
+                skip_ws();
+                if (consume(']')) ok = true;
+                else if (!consume(',')) return false;
+            }
+        } else if (consume_word("true")) {
+            value.type = JsonValue::BOOL;
+            value.boolean = ok = true;
+        } else if (consume_word("false")) {
+            value.type = JsonValue::BOOL;
+            ok = true;
+        } else if (consume_word("null")) {
+            ok = true;
+        } else {
+            value.type = JsonValue::NUMBER;
+            ok = parse_number(value.number);
+        }
+
+        value.raw = text_.substr(start, pos_ - start);
+        return ok;
+    }
+};
+
+std::string json_escape(const std::string& str) {
+    std::string out;
+    out.reserve(str.size() + 2);
+    out += '"';
+    for (unsigned char c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+bool get_int(const JsonObject& obj, const char* key, int& out, int min, int max, std::string& error) {
+    auto it = obj.find(key);
+    if (it == obj.end() || it->second.type == JsonValue::NUL) return true;
+    if (it->second.type != JsonValue::NUMBER || it->second.number < min || it->second.number > max) {
+        error = std::string("\"") + key + "\" must be a number between " + std::to_string(min) +
+                " and " + std::to_string(max);
+        return false;
+    }
+    out = static_cast<int>(it->second.number);
+    return true;
+}
+
+bool get_color(const JsonObject& obj, const char* key, fastqr::QROptions::Color& color, std::string& error) {
+    auto it = obj.find(key);
+    if (it == obj.end() || it->second.type == JsonValue::NUL) return true;
+
+    double rgb[3];
+    const JsonValue& value = it->second;
+    bool ok = false;
+    if (value.type == JsonValue::ARRAY && value.array.size() == 3) {
+        std::copy(value.array.begin(), value.array.end(), rgb);
+        ok = true;
+    } else if (value.type == JsonValue::STRING) {
+        ok = std::sscanf(value.string.c_str(), "%lf,%lf,%lf", &rgb[0], &rgb[1], &rgb[2]) == 3;
+    }
+    for (int i = 0; ok && i < 3; i++) {
+        ok = rgb[i] >= 0 && rgb[i] <= 255;
+    }
+    if (!ok) {
+        error = std::string("\"") + key + "\" must be [r,g,b] or \"r,g,b\" with values 0-255";
+        return false;
+    }
+    color.r = static_cast<uint8_t>(rgb[0]);
+    color.g = static_cast<uint8_t>(rgb[1]);
+    color.b = static_cast<uint8_t>(rgb[2]);
+    return true;
+}
+
+// Apply request fields on top of the command-line defaults (same limits as the CLI flags)
+bool apply_request(const JsonObject& req, fastqr::QROptions& options, std::string& error) {
+    if (!get_int(req, "size", options.size, 1, 10000, error)) return false;
+
+    auto it = req.find("optimize");
+    if (it != req.end() && it->second.type == JsonValue::BOOL) {
+        options.optimize_size = it->second.boolean;
+    }
+
+    if (!get_color(req, "foreground", options.foreground, error)) return false;
+    if (!get_color(req, "background", options.background, error)) return false;
+
+    it = req.find("error_level");
+    if (it != req.end() && it->second.type != JsonValue::NUL) {
+        const std::string& level = it->second.string;
+        if (level == "L") options.ec_level = fastqr::ErrorCorrectionLevel::LOW;
+        else if (level == "M") options.ec_level = fastqr::ErrorCorrectionLevel::MEDIUM;
+        else if (level == "Q") options.ec_level = fastqr::ErrorCorrectionLevel::QUARTILE;
+        else if (level == "H") options.ec_level = fastqr::ErrorCorrectionLevel::HIGH;
+        else {
+            error = "\"error_level\" must be L, M, Q or H";
+            return false;
+        }
+    }
+
+    it = req.find("logo");
+    if (it != req.end() && it->second.type == JsonValue::STRING) {
+        options.logo_path = it->second.string;
+    }
+    if (!get_int(req, "logo_size", options.logo_size_percent, 1, 50, error)) return false;
+    if (!get_int(req, "quality", options.quality, 1, 100, error)) return false;
+
+    // Absolute margin disables margin_modules, like -m on the command line
+    it = req.find("margin");
+    if (it != req.end() && it->second.type != JsonValue::NUL) {
+        if (!get_int(req, "margin", options.margin, 0, 1000, error)) return false;
+        options.margin_modules = 0;
+    }
+    if (!get_int(req, "margin_modules", options.margin_modules, 0, 50, error)) return false;
+
+    // Mask: 0-7, or "fast" / "auto"
+    it = req.find("mask");
+    if (it != req.end() && it->second.type == JsonValue::STRING) {
+        if (it->second.string == "auto") options.mask = fastqr::QROptions::MASK_AUTO;
+        else if (it->second.string == "fast") options.mask = fastqr::QROptions::MASK_FAST;
+        else {
+            error = "\"mask\" must be 0-7, \"fast\" or \"auto\"";
+            return false;
+        }
+    } else if (!get_int(req, "mask", options.mask, 0, 7, error)) {
+        return false;
+    }
+
+    // Segmentation: "optimal" or "compat"
+    it = req.find("segments");
+    if (it != req.end() && it->second.type != JsonValue::NUL) {
+        if (it->second.type == JsonValue::STRING && it->second.string == "optimal") {
+            options.segmentation = fastqr::QROptions::SEGMENT_OPTIMAL;
+        } else if (it->second.type == JsonValue::STRING && it->second.string == "compat") {
+            options.segmentation = fastqr::QROptions::SEGMENT_COMPAT;
+        } else {
+            error = "\"segments\" must be \"optimal\" or \"compat\"";
+            return false;
+        }
+    }
+
+    // Scaling: "nearest" or "area"
+    it = req.find("scaling");
+    if (it != req.end() && it->second.type != JsonValue::NUL) {
+        if (it->second.type == JsonValue::STRING && it->second.string == "nearest") {
+            options.scaling = fastqr::QROptions::SCALE_NEAREST;
+        } else if (it->second.type == JsonValue::STRING && it->second.string == "area") {
+            options.scaling = fastqr::QROptions::SCALE_AREA;
+        } else {
+            error = "\"scaling\" must be \"nearest\" or \"area\"";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void write_header(FILE* out, const std::string& id, const std::string& body) {
+    std::string line = "{";
+    if (!id.empty()) {
+        line += "\"id\":" + id + ",";
+    }
+    line += body + "}\n";
+    std::fwrite(line.data(), 1, line.size(), out);
+}
+
+} // namespace
+
+int run_serve_mode(const fastqr::QROptions& defaults, FILE* in, FILE* out) {
+    std::string line;
+    std::vector<uint8_t> png;
+    char chunk[4096];
+
+    for (;;) {
+        // Read one request line (arbitrary length)
+        line.clear();
+        bool got_line = false;
+        while (std::fgets(chunk, sizeof(chunk), in)) {
+            got_line = true;
+            line += chunk;
+            if (!line.empty() && line.back() == '\n') break;
+        }
+        if (!got_line) break;  // EOF - client closed the pipe
+
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
+        }
+        if (line.empty()) continue;
+
+        JsonObject req;
+        std::string error;
+        std::string id;
+
+        if (!JsonParser(line).parse_object(req, error)) {
+            write_header(out, id, "\"ok\":false,\"error\":" + json_escape(error));
+            std::fflush(out);
+            continue;
+        }
+
+        auto it = req.find("id");
+        if (it != req.end()) {
+            id = it->second.raw;
+        }
+
+        fastqr::QROptions options = defaults;
+        it = req.find("data");
+        if (it == req.end() || it->second.type != JsonValue::STRING || it->second.string.empty()) {
+            error = "\"data\" must be a non-empty string";
+        } else {
+            apply_request(req, options, error);
+        }
+
+        if (error.empty()) {
+            const std::string& data = it->second.string;
+            auto output = req.find("output");
+
+            if (output != req.end() && output->second.type == JsonValue::STRING && !output->second.string.empty()) {
+                if (fastqr::generate(data, output->second.string, options)) {
+                    write_header(out, id, "\"ok\":true,\"output\":" + json_escape(output->second.string));
+                } else {
+                    error = "Failed to generate QR code";
+                }
+            } else if (fastqr::generate_to_buffer(data, png, options)) {
+                // Header announces the exact payload length, then raw PNG bytes
+                write_header(out, id, "\"ok\":true,\"size\":" + std::to_string(png.size()));
+                std::fwrite(png.data(), 1, png.size(), out);
+            } else {
+                error = "Failed to generate QR code";
+            }
+        }
+
+        if (!error.empty()) {
+            write_header(out, id, "\"ok\":false,\"error\":" + json_escape(error));
+        }
+        std::fflush(out);
+    }
+
+    return 0;
+}
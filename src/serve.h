@@ -0,0 +1,51 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_SERVE_H
+#define FASTQR_SERVE_H
+
+#include "fastqr.h"
+#include <cstdio>
+
+/**
+ * Persistent worker mode (fastqr --serve)
+ *
+ * Reads one JSON request per line from `in` and writes one response per
+ * request to `out`, until end of input. Request fields:
+ *
+ *   {"id": 1, "data": "Hello", "output": "qr.png", "size": 300, ...}
+ *
+ * "data" is required; "id" is echoed back; "output" writes a file instead
+ * of returning bytes. Other keys mirror the long CLI options: size,
+ * optimize, foreground, background ([r,g,b] or "r,g,b"), error_level,
+ * logo, logo_size, quality, margin, margin_modules. Missing keys use
+ * `defaults` (the options given on the command line).
+ *
+ * Each response is a JSON header line:
+ *
+ *   {"id":1,"ok":true,"size":1234}\n  followed by exactly 1234 PNG bytes
+ *   {"id":1,"ok":true,"output":"qr.png"}\n
+ *   {"id":1,"ok":false,"error":"..."}\n
+ *
+ * @return Process exit code
+ */
+int run_serve_mode(const fastqr::QROptions& defaults, FILE* in, FILE* out);
+
+#endif // FASTQR_SERVE_H
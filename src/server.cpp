@@ -0,0 +1,873 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+// fastqr-server: minimal HTTP/1.1 front end for the in-memory encoder.
+//
+// One I/O thread multiplexes every connection with epoll (keep-alive,
+// pipelined requests handled in order). Parsed requests go to a fixed pool
+// of render threads; finished responses come back through an eventfd.
+//
+//   GET  /qr?data=Hello&size=300
+//   POST /qr?size=300            (body = data, or form-encoded parameters)
+
+#include "fastqr.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace {
+
+const size_t MAX_HEADER_BYTES = 8192;
+const size_t MAX_BODY_BYTES = 64 * 1024;  // QR payloads top out at ~3KB
+const int MAX_EVENTS = 256;
+
+// ---------------------------------------------------------------------------
+// Request / response
+
+struct Job {
+    int fd;
+    uint64_t conn_id;
+    bool keep_alive;
+    std::string method;
+    std::string target;
+    std::string content_type;
+    std::string body;
+};
+
+struct Done {
+    int fd;
+    uint64_t conn_id;
+    bool keep_alive;
+    std::string response;
+};
+
+const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        default: return "Error";
+    }
+}
+
+std::string make_response(int status, const char* content_type, const void* body, size_t length,
+                          bool keep_alive) {
+    char header[256];
+    int n = std::snprintf(header, sizeof(header),
+                          "HTTP/1.1 %d %s\r\n"
+                          "Content-Type: %s\r\n"
+                          "Content-Length: %zu\r\n"
+                          "Connection: %s\r\n"
+                          "\r\n",
+                          status, status_text(status), content_type, length,
+                          keep_alive ? "keep-alive" : "close");
+    std::string response;
+    response.reserve(n + length);
+    response.append(header, n);
+    response.append(static_cast<const char*>(body), length);
+    return response;
+}
+
+std::string error_response(int status, const std::string& message, bool keep_alive) {
+    std::string body = message + "\n";
+    return make_response(status, "text/plain", body.data(), body.size(), keep_alive);
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string url_decode(const std::string& str, size_t begin, size_t end) {
+    std::string out;
+    out.reserve(end - begin);
+    for (size_t i = begin; i < end; i++) {
+        char c = str[i];
+        if (c == '+') {
+            out += ' ';
+        } else if (c == '%' && i + 2 < end && hex_value(str[i + 1]) >= 0 && hex_value(str[i + 2]) >= 0) {
+            out += static_cast<char>(hex_value(str[i + 1]) * 16 + hex_value(str[i + 2]));
+            i += 2;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// Parse "a=1&b=2" into params (later keys win)
+void parse_params(const std::string& str, size_t begin, std::map<std::string, std::string>& params) {
+    while (begin < str.size()) {
+        size_t amp = str.find('&', begin);
+        if (amp == std::string::npos) amp = str.size();
+        size_t eq = str.find('=', begin);
+        if (eq != std::string::npos && eq < amp) {
+            params[url_decode(str, begin, eq)] = url_decode(str, eq + 1, amp);
+        } else if (amp > begin) {
+            params[url_decode(str, begin, amp)] = "";
+        }
+        begin = amp + 1;
+    }
+}
+
+bool parse_int(const std::string& str, int min, int max, int& out) {
+    char* end = nullptr;
+    long value = std::strtol(str.c_str(), &end, 10);
+    if (str.empty() || *end != '\0' || value < min || value > max) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+bool parse_color(const std::string& str, fastqr::QROptions::Color& color) {
+    int r, g, b;
+    if (std::sscanf(str.c_str(), "%d,%d,%d", &r, &g, &b) != 3) return false;
+    if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255) return false;
+    color.r = r;
+    color.g = g;
+    color.b = b;
+    return true;
+}
+
+// Query parameters use the CLI long option names. Logos are not exposed:
+// a network client must not be able to make the server read local files.
+bool apply_params(const std::map<std::string, std::string>& params, fastqr::QROptions& options,
+                  std::string& error) {
+    for (const auto& kv : params) {
+        const std::string& key = kv.first;
+        const std::string& value = kv.second;
+
+        if (key == "data") {
+            continue;
+        } else if (key == "size") {
+            if (!parse_int(value, 1, 10000, options.size)) error = "size must be between 1 and 10000";
+        } else if (key == "optimize") {
+            options.optimize_size = value.empty() || value == "1" || value == "true";
+        } else if (key == "foreground") {
+            if (!parse_color(value, options.foreground)) error = "foreground must be R,G,B";
+        } else if (key == "background") {
+            if (!parse_color(value, options.background)) error = "background must be R,G,B";
+        } else if (key == "error_level") {
+            if (value == "L") options.ec_level = fastqr::ErrorCorrectionLevel::LOW;
+            else if (value == "M") options.ec_level = fastqr::ErrorCorrectionLevel::MEDIUM;
+            else if (value == "Q") options.ec_level = fastqr::ErrorCorrectionLevel::QUARTILE;
+            else if (value == "H") options.ec_level = fastqr::ErrorCorrectionLevel::HIGH;
+            else error = "error_level must be L, M, Q or H";
+        } else if (key == "quality") {
+            if (!parse_int(value, 1, 100, options.quality)) error = "quality must be between 1 and 100";
+        } else if (key == "margin") {
+            if (!parse_int(value, 0, 1000, options.margin)) error = "margin must be between 0 and 1000";
+            // Absolute margin disables margin_modules. Keys are visited in sorted
+            // order, so an explicit margin_modules (sorted after) still wins.
+            options.margin_modules = 0;
+        } else if (key == "margin_modules") {
+            if (!parse_int(value, 0, 50, options.margin_modules)) error = "margin_modules must be between 0 and 50";
+        } else if (key == "mask") {
+            if (value == "auto") options.mask = fastqr::QROptions::MASK_AUTO;
+            else if (value == "fast") options.mask = fastqr::QROptions::MASK_FAST;
+            else if (!parse_int(value, 0, 7, options.mask)) error = "mask must be 0-7, fast or auto";
+        } else if (key == "segments") {
+            if (value == "optimal") options.segmentation = fastqr::QROptions::SEGMENT_OPTIMAL;
+            else if (value == "compat") options.segmentation = fastqr::QROptions::SEGMENT_COMPAT;
+            else error = "segments must be optimal or compat";
+        } else if (key == "scaling") {
+            if (value == "nearest") options.scaling = fastqr::QROptions::SCALE_NEAREST;
+            else if (value == "area") options.scaling = fastqr::QROptions::SCALE_AREA;
+            else error = "scaling must be nearest or area";
+        } else {
+            error = "unknown parameter: " + key;
+        }
+        if (!error.empty()) return false;
+    }
+    return true;
+}
+
+std::string render(const Job& job, std::vector<uint8_t>& png) {
+    size_t query = job.target.find('?');
+    std::string path = job.target.substr(0, query);
+    if (path != "/qr") {
+        return error_response(404, "Not found (use /qr)", job.keep_alive);
+    }
+    if (job.method != "GET" && job.method != "POST") {
+        return error_response(405, "Only GET and POST are supported", job.keep_alive);
+    }
+
+    std::map<std::string, std::string> params;
+    if (query != std::string::npos) {
+        parse_params(job.target, query + 1, params);
+    }
+
+    std::string data;
+    if (job.method == "POST") {
+        // Form fields if they carry "data", otherwise the raw body is the payload
+        // (curl --data-binary sends the form content type by default)
+        std::map<std::string, std::string> form;
+        if (job.content_type.compare(0, 33, "application/x-www-form-urlencoded") == 0) {
+            parse_params(job.body, 0, form);
+        }
+        if (form.count("data")) {
+            for (auto& kv : form) {
+                params[kv.first] = std::move(kv.second);
+            }
+        } else {
+            data = job.body;
+        }
+    }
+    auto it = params.find("data");
+    if (data.empty() && it != params.end()) {
+        data = it->second;
+    }
+    if (data.empty()) {
+        return error_response(400, "Missing data", job.keep_alive);
+    }
+
+    fastqr::QROptions options;
+    std::string error;
+    if (!apply_params(params, options, error)) {
+        return error_response(400, error, job.keep_alive);
+    }
+
+    if (!fastqr::generate_to_buffer(data, png, options)) {
+        return error_response(500, "Failed to generate QR code", job.keep_alive);
+    }
+    return make_response(200, "image/png", png.data(), png.size(), job.keep_alive);
+}
+
+// ---------------------------------------------------------------------------
+// Render pool: fixed threads, FIFO queue in, completion queue + eventfd out
+
+class RenderPool {
+public:
+    RenderPool(int threads, int wake_fd) : wake_fd_(wake_fd) {
+        for (int i = 0; i < threads; i++) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~RenderPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) {
+            t.join();
+        }
+    }
+
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+    }
+
+    void take_done(std::vector<Done>& out) {
+        std::lock_guard<std::mutex> lock(done_mutex_);
+        out.swap(done_);
+    }
+
+private:
+    void run() {
+        std::vector<uint8_t> png;  // Reused across requests on this thread
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (stopping_) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+
+            Done done{job.fd, job.conn_id, job.keep_alive, render(job, png)};
+            {
+                std::lock_guard<std::mutex> lock(done_mutex_);
+                done_.push_back(std::move(done));
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    int wake_fd_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+    std::mutex done_mutex_;
+    std::vector<Done> done_;
+};
+
+// ---------------------------------------------------------------------------
+// Connections (owned by the I/O thread only)
+
+struct Connection {
+    int fd = -1;
+    uint64_t id = 0;            // Distinguishes reused fd numbers
+    std::string in;
+    std::string out;
+    size_t out_pos = 0;
+    bool busy = false;          // Request currently in the render pool
+    bool close_after = false;   // Close once `out` is flushed
+    bool want_write = false;    // EPOLLOUT registered
+    bool read_closed = false;   // Client shut down its side; answer what is buffered, then close
+};
+
+enum ParseResult { PARSE_INCOMPLETE, PARSE_OK, PARSE_ERROR };
+
+std::string lowercase(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
+
+// Parse one request from the front of conn.in
+ParseResult parse_request(Connection& conn, Job& job, int& error_status) {
+    size_t header_end = conn.in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        if (conn.in.size() > MAX_HEADER_BYTES) {
+            error_status = 431;
+            return PARSE_ERROR;
+        }
+        return PARSE_INCOMPLETE;
+    }
+
+    // Request line: METHOD SP TARGET SP VERSION
+    size_t line_end = conn.in.find("\r\n");
+    std::string line = conn.in.substr(0, line_end);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 == sp1) {
+        error_status = 400;
+        return PARSE_ERROR;
+    }
+    job.method = line.substr(0, sp1);
+    job.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string version = line.substr(sp2 + 1);
+
+    // Headers we care about
+    size_t content_length = 0;
+    std::string connection;
+    size_t pos = line_end + 2;
+    while (pos < header_end) {
+        size_t eol = conn.in.find("\r\n", pos);
+        size_t colon = conn.in.find(':', pos);
+        if (colon != std::string::npos && colon < eol) {
+            std::string name = lowercase(conn.in.substr(pos, colon - pos));
+            size_t vbegin = conn.in.find_first_not_of(" \t", colon + 1);
+            std::string value = vbegin < eol ? conn.in.substr(vbegin, eol - vbegin) : "";
+            if (name == "content-length") {
+                content_length = std::strtoul(value.c_str(), nullptr, 10);
+            } else if (name == "connection") {
+                connection = lowercase(value);
+            } else if (name == "content-type") {
+                job.content_type = lowercase(value);
+            } else if (name == "transfer-encoding") {
+                error_status = 501;  // Chunked bodies are not supported
+                return PARSE_ERROR;
+            }
+        }
+        pos = eol + 2;
+    }
+
+    if (content_length > MAX_BODY_BYTES) {
+        error_status = 413;
+        return PARSE_ERROR;
+    }
+    size_t total = header_end + 4 + content_length;
+    if (conn.in.size() < total) {
+        return PARSE_INCOMPLETE;
+    }
+
+    job.body = conn.in.substr(header_end + 4, content_length);
+    job.keep_alive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+    job.fd = conn.fd;
+    job.conn_id = conn.id;
+    conn.in.erase(0, total);
+    return PARSE_OK;
+}
+
+class Server {
+public:
+    Server(int listen_fd, int threads)
+        : listen_fd_(listen_fd),
+          epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+          wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          spare_fd_(open("/dev/null", O_RDONLY | O_CLOEXEC)),
+          pool_(new RenderPool(threads, wake_fd_)) {
+        add(listen_fd_, EPOLLIN);
+        add(wake_fd_, EPOLLIN);
+    }
+
+    ~Server() {
+        pool_.reset();  // Join render threads before their wake fd goes away
+        for (auto& kv : conns_) {
+            close(kv.first);
+        }
+        if (spare_fd_ >= 0) close(spare_fd_);
+        close(wake_fd_);
+        close(epoll_fd_);
+    }
+
+    int wake_fd() const { return wake_fd_; }
+
+    void run(const std::atomic<bool>& stop) {
+        epoll_event events[MAX_EVENTS];
+        while (!stop.load()) {
+            int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listen_fd_) {
+                    accept_all();
+                } else if (fd == wake_fd_) {
+                    drain_completions();
+                } else {
+                    handle_io(fd, events[i].events);
+                }
+            }
+        }
+    }
+
+private:
+    void add(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void set_want_write(Connection& conn, bool want) {
+        if (conn.want_write == want) return;
+        conn.want_write = want;
+        update_events(conn);
+    }
+
+    // Re-register what the connection waits for: input until the client shuts
+    // down its side (EOF stays readable, so it would fire forever), output
+    // while a response is waiting for socket space
+    void update_events(Connection& conn) {
+        uint32_t events = 0;
+        if (!conn.read_closed) events |= EPOLLIN | EPOLLRDHUP;
+        if (conn.want_write) events |= EPOLLOUT;
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = conn.fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+
+    void close_conn(int fd) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns_.erase(fd);
+        if (spare_fd_ < 0) {
+            spare_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        }
+        if (listen_paused_) {
+            set_listening(true);
+        }
+    }
+
+    // Stop (or resume) polling the listener. Used when we are out of fds
+    // and cannot even shed the pending connection: the listener stays
+    // readable, and with level-triggered epoll that would spin.
+    void set_listening(bool on) {
+        listen_paused_ = !on;
+        epoll_event ev{};
+        if (on) ev.events = EPOLLIN;
+        ev.data.fd = listen_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, listen_fd_, &ev);
+    }
+
+    // Out of fds (EMFILE/ENFILE): give up the spare fd so the pending
+    // connection can be accepted and closed right away, then take the spare
+    // back. Returns 0 if a connection was shed, else accept's errno (accept
+    // fails with EMFILE before looking at the queue, so EAGAIN here is the
+    // first sign the queue is empty).
+    int shed_connection() {
+        if (spare_fd_ < 0) return EMFILE;
+        close(spare_fd_);
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        int err = fd < 0 ? errno : 0;
+        if (fd >= 0) close(fd);
+        spare_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return err;
+    }
+
+    void accept_all() {
+        for (;;) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                int err = errno;
+                if (err == EINTR || err == ECONNABORTED) continue;
+                if (err == EMFILE || err == ENFILE) {
+                    err = shed_connection();
+                    if (err == 0 || err == EINTR || err == ECONNABORTED) continue;
+                }
+                if (err == EAGAIN || err == EWOULDBLOCK) return;
+                std::cerr << "Warning: accept failed: " << std::strerror(err) << std::endl;
+                if (err == EMFILE || err == ENFILE) {
+                    set_listening(false);  // Resume once a connection closes
+                }
+                return;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            Connection& conn = conns_[fd];
+            conn = Connection();
+            conn.fd = fd;
+            conn.id = ++next_id_;
+            add(fd, EPOLLIN | EPOLLRDHUP);
+        }
+    }
+
+    // Returns false if the connection was closed
+    bool flush(Connection& conn) {
+        while (conn.out_pos < conn.out.size()) {
+            ssize_t n = send(conn.fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_pos += n;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                set_want_write(conn, true);
+                return true;
+            } else {
+                close_conn(conn.fd);
+                return false;
+            }
+        }
+
+        conn.out.clear();
+        conn.out_pos = 0;
+        set_want_write(conn, false);
+        if (conn.close_after) {
+            close_conn(conn.fd);
+            return false;
+        }
+        return true;
+    }
+
+    // Hand the next buffered request to the pool (one in flight per connection
+    // keeps pipelined responses in order)
+    void dispatch(Connection& conn) {
+        if (conn.busy || conn.close_after) return;
+
+        Job job;
+        int error_status = 400;
+        switch (parse_request(conn, job, error_status)) {
+            case PARSE_INCOMPLETE:
+                if (conn.read_closed) {
+                    // Nothing more will arrive: close once earlier responses are out
+                    conn.close_after = true;
+                    conn.in.clear();
+                    flush(conn);
+                }
+                return;
+            case PARSE_OK:
+                conn.busy = true;
+                pool_->submit(std::move(job));
+                return;
+            case PARSE_ERROR:
+                conn.out += error_response(error_status, status_text(error_status), false);
+                conn.close_after = true;
+                conn.in.clear();
+                flush(conn);
+                return;
+        }
+    }
+
+    void drain_completions() {
+        uint64_t count;
+        ssize_t ignored = read(wake_fd_, &count, sizeof(count));
+        (void)ignored;
+
+        std::vector<Done> done;
+        pool_->take_done(done);
+        for (Done& d : done) {
+            auto it = conns_.find(d.fd);
+            if (it == conns_.end() || it->second.id != d.conn_id) {
+                continue;  // Client went away while we were rendering
+            }
+            Connection& conn = it->second;
+            conn.busy = false;
+            conn.out += d.response;
+            if (!d.keep_alive) conn.close_after = true;
+            if (flush(conn)) {
+                dispatch(conn);
+            }
+        }
+    }
+
+    void handle_io(int fd, uint32_t events) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end()) return;
+        Connection& conn = it->second;
+
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            close_conn(fd);
+            return;
+        }
+        if ((events & EPOLLOUT) && !flush(conn)) {
+            return;
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP)) {
+            char buf[16384];
+            for (;;) {
+                ssize_t n = recv(fd, buf, sizeof(buf), 0);
+                if (n > 0) {
+                    conn.in.append(buf, n);
+                    if (conn.in.size() > MAX_HEADER_BYTES + MAX_BODY_BYTES + sizeof(buf)) {
+                        close_conn(fd);  // Client is flooding us with pipelined data
+                        return;
+                    }
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    break;
+                } else if (n == 0) {
+                    // Half-close (e.g. shutdown(SHUT_WR) after the request):
+                    // still answer every complete request already read
+                    conn.read_closed = true;
+                    update_events(conn);
+                    break;
+                } else {
+                    close_conn(fd);
+                    return;
+                }
+            }
+            dispatch(conn);
+        }
+    }
+
+    int listen_fd_;
+    int epoll_fd_;
+    int wake_fd_;
+    int spare_fd_;  // Reserved so we can still shed connections at the fd limit
+    bool listen_paused_ = false;
+    std::unique_ptr<RenderPool> pool_;
+    std::unordered_map<int, Connection> conns_;
+    uint64_t next_id_ = 0;
+};
+
+int open_listener(const std::string& host, int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Error: Invalid host address: " << host << std::endl;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Error: socket() failed: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        std::cerr << "Error: Cannot listen on " << host << ":" << port << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::atomic<bool> g_stop(false);
+int g_wake_fd = -1;
+
+void handle_signal(int) {
+    g_stop.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = write(g_wake_fd, &one, sizeof(one));  // Break out of epoll_wait
+    (void)ignored;
+}
+
+void print_usage(const char* program_name) {
+    std::cout << "FastQR v" << fastqr::version() << " - QR Code HTTP Server\n\n";
+    std::cout << "Usage: " << program_name << " [OPTIONS]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --host ADDR             IPv4 address to bind (default: 127.0.0.1)\n";
+    std::cout << "  -p, --port N            Port to listen on (default: 8080)\n";
+    std::cout << "  -t, --threads N         Render threads (default: all cores)\n";
+    std::cout << "  --matrix-cache N[,MB]   Reuse the encoded matrix of repeated data (N entries, MB limit)\n";
+    std::cout << "  --output-cache N[,MB]   Reuse the image of repeated requests (N entries, MB limit)\n";
+    std::cout << "  --output-cache-dir DIR  Also keep cached images in DIR across restarts\n";
+    std::cout << "  -h, --help              Show this help\n";
+    std::cout << "  -v, --version           Show version\n\n";
+    std::cout << "Endpoints:\n";
+    std::cout << "  GET  /qr?data=Hello&size=300&error_level=H\n";
+    std::cout << "  POST /qr?size=300   (body is the data, or form-encoded parameters)\n\n";
+    std::cout << "Parameters: data, size, optimize, foreground, background (R,G,B),\n";
+    std::cout << "            error_level, quality, margin, margin_modules, mask (0-7|fast|auto),\n";
+    std::cout << "            segments (optimal|compat), scaling (nearest|area)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int threads = 0;  // 0 = use all cores
+    unsigned long output_cache_entries = 0, output_cache_mb = 0;
+    std::string output_cache_dir;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "-v" || arg == "--version") {
+            std::cout << "FastQR v" << fastqr::version() << std::endl;
+            return 0;
+        } else if (arg == "--host" || arg == "-p" || arg == "--port" || arg == "-t" || arg == "--threads") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            if (arg == "--host") {
+                host = argv[i];
+            } else if (arg == "-p" || arg == "--port") {
+                port = atoi(argv[i]);
+                if (port < 1 || port > 65535) {
+                    std::cerr << "Error: Port must be between 1 and 65535\n";
+                    return 1;
+                }
+            } else {
+                threads = atoi(argv[i]);
+                if (threads < 1 || threads > 1024) {
+                    std::cerr << "Error: Threads must be between 1 and 1024\n";
+                    return 1;
+                }
+            }
+        } else if (arg == "--matrix-cache") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            unsigned long entries = 0, mb = 0;
+            int n = sscanf(argv[i], "%lu,%lu", &entries, &mb);
+            if (n < 1 || entries == 0) {
+                std::cerr << "Error: Invalid matrix cache size. Use ENTRIES or ENTRIES,MB (e.g., 10000,64)\n";
+                return 1;
+            }
+            fastqr::set_matrix_cache(entries, n == 2 ? mb << 20 : 0);
+        } else if (arg == "--output-cache") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            if (sscanf(argv[i], "%lu,%lu", &output_cache_entries, &output_cache_mb) < 1 || output_cache_entries == 0) {
+                std::cerr << "Error: Invalid output cache size. Use ENTRIES or ENTRIES,MB (e.g., 1000,256)\n";
+                return 1;
+            }
+        } else if (arg == "--output-cache-dir") {
+            if (++i >= argc) {
+                std::cerr << "Error: " << arg << " requires an argument\n";
+                return 1;
+            }
+            output_cache_dir = argv[i];
+        } else {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if ((output_cache_entries > 0 || !output_cache_dir.empty()) &&
+        !fastqr::set_output_cache(output_cache_entries, output_cache_mb << 20, output_cache_dir)) {
+        std::cerr << "Error: Cannot create directory: " << output_cache_dir << std::endl;
+        return 1;
+    }
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) threads = 1;
+    }
+
+    int listen_fd = open_listener(host, port);
+    if (listen_fd < 0) {
+        return 1;
+    }
+
+    {
+        Server server(listen_fd, threads);
+        g_wake_fd = server.wake_fd();
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+
+        std::cerr << "fastqr-server listening on http://" << host << ":" << port
+                  << " (" << threads << " render threads)" << std::endl;
+        server.run(g_stop);
+    }
+
+    fastqr::CacheStats cache = fastqr::matrix_cache_stats();
+    if (cache.max_entries > 0) {
+        std::cerr << "matrix cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.evictions
+                  << " evicted" << std::endl;
+    }
+    cache = fastqr::output_cache_stats();
+    if (cache.hits + cache.misses > 0) {
+        std::cerr << "output cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.evictions
+                  << " evicted" << std::endl;
+    }
+
+    close(listen_fd);
+    return 0;
+}
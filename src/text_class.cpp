@@ -0,0 +1,238 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#include "text_class.h"
+#include "kanji_table.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace fastqr {
+namespace qr {
+namespace {
+
+// ---------------------------------------------------------------------------
+// Scalar classification of one ASCII byte
+
+constexpr bool is_alnum_char(int c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || c == ' ' || c == '$' || c == '%' ||
+           c == '*' || c == '+' || c == '-' || c == '.' || c == '/' || c == ':';
+}
+
+struct AsciiTable {
+    uint8_t modes[128];
+};
+
+constexpr AsciiTable build_ascii_table() {
+    AsciiTable t{};
+    for (int c = 0; c < 128; c++) {
+        t.modes[c] = CAN_8;
+        if (is_alnum_char(c)) t.modes[c] |= CAN_AN;
+        if (c >= '0' && c <= '9') t.modes[c] |= CAN_NUM;
+    }
+    return t;
+}
+
+constexpr AsciiTable ASCII = build_ascii_table();
+
+// ---------------------------------------------------------------------------
+// Vector classification of ASCII runs. Each ISA supplies byte-mask
+// primitives (0xFF = true); the kernel is shared.
+
+#if defined(__AVX2__)
+
+struct Simd {
+    using V = __m256i;
+    static const size_t WIDTH = 32;
+    static V load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint8_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V splat(int c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+    static V eq(V v, int c) { return _mm256_cmpeq_epi8(v, splat(c)); }
+    // ASCII only: bytes >= 0x80 compare as negative and fall outside
+    static V in_range(V v, int lo, int hi) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, splat(lo - 1)), _mm256_cmpgt_epi8(splat(hi + 1), v));
+    }
+    static V bit_or(V a, V b) { return _mm256_or_si256(a, b); }
+    static V bit_and(V a, V b) { return _mm256_and_si256(a, b); }
+    static bool all(V m) { return _mm256_movemask_epi8(m) == -1; }
+    static bool any_high(V v) { return _mm256_movemask_epi8(v) != 0; }
+};
+#define FASTQR_TEXT_SIMD 1
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+struct Simd {
+    using V = __m128i;
+    static const size_t WIDTH = 16;
+    static V load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint8_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V splat(int c) { return _mm_set1_epi8(static_cast<char>(c)); }
+    static V eq(V v, int c) { return _mm_cmpeq_epi8(v, splat(c)); }
+    // ASCII only: bytes >= 0x80 compare as negative and fall outside
+    static V in_range(V v, int lo, int hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, splat(lo - 1)), _mm_cmplt_epi8(v, splat(hi + 1)));
+    }
+    static V bit_or(V a, V b) { return _mm_or_si128(a, b); }
+    static V bit_and(V a, V b) { return _mm_and_si128(a, b); }
+    static bool all(V m) { return _mm_movemask_epi8(m) == 0xFFFF; }
+    static bool any_high(V v) { return _mm_movemask_epi8(v) != 0; }
+};
+#define FASTQR_TEXT_SIMD 1
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+struct Simd {
+    using V = uint8x16_t;
+    static const size_t WIDTH = 16;
+    static V load(const char* p) { return vld1q_u8(reinterpret_cast<const uint8_t*>(p)); }
+    static void store(uint8_t* p, V v) { vst1q_u8(p, v); }
+    static V splat(int c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+    static V eq(V v, int c) { return vceqq_u8(v, splat(c)); }
+    static V in_range(V v, int lo, int hi) { return vandq_u8(vcgeq_u8(v, splat(lo)), vcleq_u8(v, splat(hi))); }
+    static V bit_or(V a, V b) { return vorrq_u8(a, b); }
+    static V bit_and(V a, V b) { return vandq_u8(a, b); }
+    static bool all(V m) { return vminvq_u8(m) == 0xFF; }
+    static bool any_high(V v) { return vmaxvq_u8(v) >= 0x80; }
+};
+#define FASTQR_TEXT_SIMD 1
+
+#endif
+
+// Classify whole vectors of ASCII from `i` on; returns where it stopped
+// (a vector holding a non-ASCII byte, or less than a vector left)
+size_t classify_ascii_run(const char* data, size_t i, size_t length, uint8_t* modes, TextClass& tc) {
+#ifdef FASTQR_TEXT_SIMD
+    using V = Simd::V;
+    const V num_bits = Simd::splat(CAN_NUM);
+    const V an_bits = Simd::splat(CAN_AN);
+    const V byte_bits = Simd::splat(CAN_8);
+
+    for (; i + Simd::WIDTH <= length; i += Simd::WIDTH) {
+        V v = Simd::load(data + i);
+        if (Simd::any_high(v)) break;
+
+        // Alphanumeric set: 0-9 A-Z and " $%*+-./:"
+        V digit = Simd::in_range(v, '0', '9');
+        V punct = Simd::bit_or(Simd::bit_or(Simd::eq(v, ' '), Simd::eq(v, ':')),
+                               Simd::bit_or(Simd::in_range(v, '$', '%'),
+                                            Simd::bit_or(Simd::in_range(v, '*', '+'), Simd::in_range(v, '-', '/'))));
+        V alnum = Simd::bit_or(Simd::bit_or(digit, Simd::in_range(v, 'A', 'Z')), punct);
+
+        tc.numeric = tc.numeric && Simd::all(digit);
+        tc.alnum = tc.alnum && Simd::all(alnum);
+        if (modes) {
+            Simd::store(modes + i, Simd::bit_or(byte_bits, Simd::bit_or(Simd::bit_and(digit, num_bits),
+                                                                         Simd::bit_and(alnum, an_bits))));
+        }
+    }
+#else
+    (void)data;
+    (void)length;
+    (void)modes;
+    (void)tc;
+#endif
+    return i;
+}
+
+} // namespace
+
+int decode_utf8(const unsigned char* p, const unsigned char* end, uint32_t& cp) {
+    static const uint32_t MIN_CODEPOINT[4] = {0, 0x80, 0x800, 0x10000};
+    int length;
+    if (p[0] < 0x80) {
+        cp = p[0];
+        return 1;
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        cp = p[0] & 0x1F;
+        length = 2;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        cp = p[0] & 0x0F;
+        length = 3;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        cp = p[0] & 0x07;
+        length = 4;
+    } else {
+        return 0;
+    }
+    if (end - p < length) return 0;
+    for (int i = 1; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    if (cp < MIN_CODEPOINT[length - 1] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+    return length;
+}
+
+int kanji_value(uint32_t cp) {
+    if (cp > 0xFFFF) return -1;
+    const uint16_t* begin = KANJI_CODEPOINTS + KANJI_PAGES[cp >> 8];
+    const uint16_t* end = KANJI_CODEPOINTS + KANJI_PAGES[(cp >> 8) + 1];
+    const uint16_t* it = std::lower_bound(begin, end, static_cast<uint16_t>(cp));
+    if (it == end || *it != cp) return -1;
+    return KANJI_VALUES[it - KANJI_CODEPOINTS];
+}
+
+TextClass classify_text(const char* data, size_t length, uint8_t* modes) {
+    TextClass tc;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    while (i < length) {
+        i = classify_ascii_run(data, i, length, modes, tc);
+        if (i >= length) break;
+
+        // One character: an ASCII byte before or after a vector, or UTF-8
+        if (p[i] < 0x80) {
+            uint8_t m = ASCII.modes[p[i]];
+            tc.numeric = tc.numeric && (m & CAN_NUM);
+            tc.alnum = tc.alnum && (m & CAN_AN);
+            if (modes) modes[i] = m;
+            i++;
+            continue;
+        }
+
+        tc.ascii = tc.numeric = tc.alnum = false;
+        uint32_t cp;
+        int n = decode_utf8(p + i, p + length, cp);
+        if (n == 0) {
+            tc.utf8 = tc.latin1 = tc.kanji = false;
+            n = 1;
+        }
+        uint8_t m = 0;
+        if (tc.utf8) {
+            if (cp > 0xFF) tc.latin1 = false;
+            if (kanji_value(cp) >= 0) m = CAN_KANJI;
+            else tc.kanji = false;
+        }
+        if (modes) {
+            modes[i] = m;
+            std::memset(modes + i + 1, 0, n - 1);
+        }
+        i += n;
+    }
+    return tc;
+}
+
+} // namespace qr
+} // namespace fastqr
@@ -0,0 +1,82 @@
+/*
+ * FastQR - Fast QR Code Generator Library
+ * Copyright (C) 2025 Tran Huu Canh and FastQR Contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://github.com/tranhuucanh/fastqr
+ */
+
+#ifndef FASTQR_TEXT_CLASS_H
+#define FASTQR_TEXT_CLASS_H
+
+// Payload classification for QR mode selection.
+//
+// One pass over the input: ASCII runs are classified 16 (SSE2, NEON) or 32
+// (AVX2) bytes at a time, only non-ASCII characters take the scalar UTF-8
+// and Kanji table path. The instruction set is picked at compile time.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fastqr {
+namespace qr {
+
+// Per-character mode bits written by classify_text() (bit index = the
+// encoder's Mode: numeric, alphanumeric, 8-bit, Kanji)
+enum ModeBits : uint8_t {
+    CAN_NUM = 1 << 0,
+    CAN_AN = 1 << 1,
+    CAN_8 = 1 << 2,
+    CAN_KANJI = 1 << 3,
+};
+
+// Facts about a whole payload (all true for an empty one)
+struct TextClass {
+    bool ascii = true;    // Every byte below 0x80
+    bool numeric = true;  // Every byte a digit
+    bool alnum = true;    // Every byte in the alphanumeric mode set
+    bool utf8 = true;     // Well-formed UTF-8
+    bool latin1 = true;   // Well-formed UTF-8, every code point <= U+00FF
+    bool kanji = true;    // Well-formed UTF-8, every non-ASCII character fits Kanji mode
+};
+
+/**
+ * Classify a payload
+ *
+ * @param data Payload bytes
+ * @param length Number of bytes
+ * @param modes If not NULL, receives `length` bytes: the ModeBits of the
+ *              character starting at each byte, 0 for UTF-8 continuation
+ *              bytes and for non-ASCII characters Kanji mode cannot hold
+ * @return The payload's facts
+ */
+TextClass classify_text(const char* data, size_t length, uint8_t* modes = nullptr);
+
+/**
+ * Decode one UTF-8 sequence
+ *
+ * @return Its length in bytes, 0 if malformed (or truncated at `end`)
+ */
+int decode_utf8(const unsigned char* p, const unsigned char* end, uint32_t& cp);
+
+/**
+ * 13-bit Kanji mode value of a code point, -1 if Kanji mode cannot hold it
+ */
+int kanji_value(uint32_t cp);
+
+} // namespace qr
+} // namespace fastqr
+
+#endif // FASTQR_TEXT_CLASS_H